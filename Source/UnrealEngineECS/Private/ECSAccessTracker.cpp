@@ -0,0 +1,142 @@
+
+#include "ECSAccessTracker.h"
+#include "UEEnTTSystem.h"
+#include "UnrealEngineECS.h"
+#include "HAL/IConsoleManager.h"
+
+bool FECSAccessTracker::bEnabled = false;
+
+#if ECS_WITH_ACCESS_TRACKING
+static FAutoConsoleVariableRef CVarTrackAccess(
+	TEXT("ecs.TrackAccess"),
+	FECSAccessTracker::bEnabled,
+	TEXT("Track the pool accesses of ECS systems and report systems that access the same pool concurrently from different threads"),
+	ECVF_Cheat);
+#endif
+
+namespace
+{
+	struct FAccessRecord
+	{
+		const UECSSystem* System = nullptr;
+		uint32 ThreadId = 0;
+		EECSAccess Access = EECSAccess::Read;
+	};
+
+	/* Maximum number of conflicts remembered per system */
+	constexpr int32 MaxConflictsPerSystem = 16;
+
+	FCriticalSection Mutex;
+	TMap<entt::id_type, TArray<FAccessRecord, TInlineAllocator<4>>> ActiveAccesses;
+	TMap<const UECSSystem*, TArray<FString>> Conflicts;
+	thread_local const UECSSystem* CurrentSystem = nullptr;
+
+	FString GetSystemName(const UECSSystem* System)
+	{
+		return System ? System->GetClass()->GetName() : FString(TEXT("None"));
+	}
+
+	const TCHAR* GetAccessName(EECSAccess Access)
+	{
+		return Access == EECSAccess::Write ? TEXT("writes") : TEXT("reads");
+	}
+
+	void AddConflict(const UECSSystem* System, const FString& Conflict)
+	{
+		TArray<FString>& SystemConflicts = Conflicts.FindOrAdd(System);
+		if (SystemConflicts.Num() < MaxConflictsPerSystem)
+		{
+			SystemConflicts.AddUnique(Conflict);
+		}
+	}
+}
+
+
+//////////////////////////////////////////////////
+void FECSAccessTracker::SetCurrentSystem(const UECSSystem* System)
+{
+	if (CurrentSystem && CurrentSystem != System)
+	{
+		ReleaseAccesses(CurrentSystem);
+	}
+	CurrentSystem = System;
+}
+
+const UECSSystem* FECSAccessTracker::GetCurrentSystem()
+{
+	return CurrentSystem;
+}
+
+//////////////////////////////////////////////////
+void FECSAccessTracker::RecordAccess(entt::id_type Pool, const TCHAR* PoolName, EECSAccess Access)
+{
+	const uint32 ThreadId = FPlatformTLS::GetCurrentThreadId();
+
+	FScopeLock Lock(&Mutex);
+	TArray<FAccessRecord, TInlineAllocator<4>>& Records = ActiveAccesses.FindOrAdd(Pool);
+
+	FAccessRecord* OwnRecord = nullptr;
+	for (FAccessRecord& Record : Records)
+	{
+		if (Record.System == CurrentSystem && Record.ThreadId == ThreadId)
+		{
+			OwnRecord = &Record;
+		}
+		else if (Record.ThreadId != ThreadId && (Access == EECSAccess::Write || Record.Access == EECSAccess::Write))
+		{
+			const FString Conflict = FString::Printf(TEXT("%s %s %s on thread %u while %s %s it on thread %u"),
+													 *GetSystemName(CurrentSystem), GetAccessName(Access), PoolName, ThreadId,
+													 *GetSystemName(Record.System), GetAccessName(Record.Access), Record.ThreadId);
+			
+			const TArray<FString>* Known = Conflicts.Find(CurrentSystem);
+			if (!Known || !Known->Contains(Conflict))
+			{
+				UE_LOG(LogUnrealECS, Warning, TEXT("ECS access conflict: %s"), *Conflict);
+			}
+			
+			AddConflict(CurrentSystem, Conflict);
+			AddConflict(Record.System, Conflict);
+		}
+	}
+
+	if (!OwnRecord)
+	{
+		Records.Add({ CurrentSystem, ThreadId, Access });
+	}
+	else if (Access == EECSAccess::Write)
+	{
+		OwnRecord->Access = EECSAccess::Write;
+	}
+}
+
+void FECSAccessTracker::ReleaseAccesses(const UECSSystem* System)
+{
+	const uint32 ThreadId = FPlatformTLS::GetCurrentThreadId();
+
+	FScopeLock Lock(&Mutex);
+	for (TPair<entt::id_type, TArray<FAccessRecord, TInlineAllocator<4>>>& Pool : ActiveAccesses)
+	{
+		Pool.Value.RemoveAllSwap([&](const FAccessRecord& Record)
+		{
+			return Record.System == System && Record.ThreadId == ThreadId;
+		}, false);
+	}
+}
+
+//////////////////////////////////////////////////
+TArray<FString> FECSAccessTracker::GetConflicts(const UECSSystem* System)
+{
+	FScopeLock Lock(&Mutex);
+	const TArray<FString>* SystemConflicts = Conflicts.Find(System);
+	return SystemConflicts ? *SystemConflicts : TArray<FString>();
+}
+
+void FECSAccessTracker::RemoveSystem(const UECSSystem* System)
+{
+	FScopeLock Lock(&Mutex);
+	for (TPair<entt::id_type, TArray<FAccessRecord, TInlineAllocator<4>>>& Pool : ActiveAccesses)
+	{
+		Pool.Value.RemoveAllSwap([System](const FAccessRecord& Record) { return Record.System == System; }, false);
+	}
+	Conflicts.Remove(System);
+}
@@ -0,0 +1,198 @@
+
+#include "ECSCollision.h"
+#include "ECSCoreSystems.h"
+#include "UnrealEngineECS.h"
+#include "Algo/Sort.h"
+#include "Async/ParallelFor.h"
+
+DECLARE_CYCLE_STAT(TEXT("Broadphase: Gather shapes"), STAT_BroadphaseGather, STATGROUP_ECS);
+DECLARE_CYCLE_STAT(TEXT("Broadphase: Find pairs"), STAT_BroadphaseFindPairs, STATGROUP_ECS);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Broadphase pairs"), STAT_BroadphasePairs, STATGROUP_ECS);
+
+
+//////////////////////////////////////////////////
+FECSBroadphase::FECSBroadphase(const FECSBroadphaseSettings& Settings)
+	: Settings(Settings)
+{
+}
+
+//////////////////////////////////////////////////
+void FECSBroadphase::Update(IECSRegistryInterface& Registry)
+{
+	{
+		SCOPE_CYCLE_COUNTER(STAT_BroadphaseGather);
+		Proxies.Reset(Registry.Size<FECSSphereShape>() + Registry.Size<FECSBoxShape>());
+		bMultipleShapesPerEntity = false;
+		AddProxies<FECSSphereShape>(Registry);
+		AddProxies<FECSBoxShape>(Registry);
+		Algo::SortBy(Proxies, [](const FProxy& Proxy) { return Proxy.Min.X; });
+	}
+
+	SCOPE_CYCLE_COUNTER(STAT_BroadphaseFindPairs);
+	const int32 ShapesPerTask = FMath::Max(Settings.ShapesPerTask, 1);
+	const int32 NumTasks = FMath::DivideAndRoundUp(Proxies.Num(), ShapesPerTask);
+	if (TaskPairs.Num() < NumTasks)
+	{
+		TaskPairs.SetNum(NumTasks);
+	}
+
+	ParallelFor(NumTasks, [this, ShapesPerTask](int32 Task)
+	{
+		const int32 Begin = Task * ShapesPerTask;
+		TaskPairs[Task].Reset();
+		FindPairs(Begin, FMath::Min(Begin + ShapesPerTask, Proxies.Num()), TaskPairs[Task]);
+	});
+
+	int32 NumPairs = 0;
+	for (int32 Task = 0; Task < NumTasks; ++Task)
+	{
+		NumPairs += TaskPairs[Task].Num();
+	}
+
+	Pairs.Reset(NumPairs);
+	for (int32 Task = 0; Task < NumTasks; ++Task)
+	{
+		Pairs.Append(TaskPairs[Task]);
+	}
+
+	// The shapes of an entity with a sphere and a box can overlap the same entity twice, and so can its partner's shapes
+	if (bMultipleShapesPerEntity)
+	{
+		Algo::Sort(Pairs, [](const FECSContactPair& First, const FECSContactPair& Second)
+		{
+			return First.A != Second.A ? First.A < Second.A : First.B < Second.B;
+		});
+		int32 NumUnique = 0;
+		for (int32 Index = 0; Index < Pairs.Num(); ++Index)
+		{
+			if (NumUnique == 0 || Pairs[Index].A != Pairs[NumUnique - 1].A || Pairs[Index].B != Pairs[NumUnique - 1].B)
+			{
+				Pairs[NumUnique++] = Pairs[Index];
+			}
+		}
+		Pairs.SetNum(NumUnique, false);
+	}
+	SET_DWORD_STAT(STAT_BroadphasePairs, Pairs.Num());
+}
+
+//////////////////////////////////////////////////
+template<typename Shape>
+void FECSBroadphase::AddProxies(IECSRegistryInterface& Registry)
+{
+	const entt::registry& EnTTRegistry = Registry.GetEntTTReg();
+
+	// Disabled entities, e.g. pooled projectiles, don't collide
+	Registry.EachEnabled(Registry.View<const Shape, const FTransform>(),
+		[this, &EnTTRegistry](entt::entity Entity, const Shape& ShapeComp, const FTransform& Transform)
+		{
+			FProxy& Proxy = Proxies.AddDefaulted_GetRef();
+			Proxy.Center = Transform.GetLocation();
+			Proxy.Entity = Entity;
+
+			// Boxes are added after the spheres
+			if constexpr (std::is_same_v<Shape, FECSBoxShape>)
+			{
+				bMultipleShapesPerEntity |= EnTTRegistry.has<FECSSphereShape>(Entity);
+			}
+
+			const FVector Scale = Transform.GetScale3D().GetAbs();
+			Proxy.bSphere = std::is_same_v<Shape, FECSSphereShape>;
+			if constexpr (std::is_same_v<Shape, FECSSphereShape>)
+			{
+				Proxy.Radius = ShapeComp.Radius * Scale.GetMax();
+				Proxy.Min = Proxy.Center - FVector(Proxy.Radius);
+				Proxy.Max = Proxy.Center + FVector(Proxy.Radius);
+			}
+			else
+			{
+				const FVector Extent = ShapeComp.Extent * Scale;
+				Proxy.Radius = 0.f;
+				Proxy.Min = Proxy.Center - Extent;
+				Proxy.Max = Proxy.Center + Extent;
+			}
+
+			const FECSCollisionFilter* Filter = EnTTRegistry.try_get<FECSCollisionFilter>(Entity);
+			Proxy.Layer = Filter ? Filter->Layer : 1;
+			Proxy.CollidesWith = Filter ? Filter->CollidesWith : ~0u;
+		});
+}
+
+//////////////////////////////////////////////////
+void FECSBroadphase::FindPairs(int32 Begin, int32 End, TArray<FECSContactPair>& OutPairs) const
+{
+	const FProxy* Sorted = Proxies.GetData();
+	const int32 Num = Proxies.Num();
+
+	for (int32 Index = Begin; Index < End; ++Index)
+	{
+		const FProxy& First = Sorted[Index];
+
+		// Sorted by Min.X, so all shapes that can overlap along X follow directly
+		for (int32 Other = Index + 1; Other < Num && Sorted[Other].Min.X <= First.Max.X; ++Other)
+		{
+			const FProxy& Second = Sorted[Other];
+			if (First.Entity == Second.Entity)
+			{
+				continue;
+			}
+			if ((First.Layer & Second.CollidesWith) == 0 && (Second.Layer & First.CollidesWith) == 0)
+			{
+				continue;
+			}
+
+			if (First.Min.Y <= Second.Max.Y && Second.Min.Y <= First.Max.Y
+				&& First.Min.Z <= Second.Max.Z && Second.Min.Z <= First.Max.Z
+				&& Overlap(First, Second))
+			{
+				OutPairs.Add(First.Entity < Second.Entity ? FECSContactPair{ First.Entity, Second.Entity }
+														  : FECSContactPair{ Second.Entity, First.Entity });
+			}
+		}
+	}
+}
+
+bool FECSBroadphase::Overlap(const FProxy& First, const FProxy& Second)
+{
+	// Not decided by the radius, a sphere scaled to zero is still a sphere
+	const bool bFirstIsSphere = First.bSphere;
+	const bool bSecondIsSphere = Second.bSphere;
+
+	if (bFirstIsSphere && bSecondIsSphere)
+	{
+		return FVector::DistSquared(First.Center, Second.Center) <= FMath::Square(First.Radius + Second.Radius);
+	}
+
+	if (bFirstIsSphere || bSecondIsSphere)
+	{
+		const FProxy& Sphere = bFirstIsSphere ? First : Second;
+		const FProxy& Box = bFirstIsSphere ? Second : First;
+		const FVector Closest = Sphere.Center.BoundToBox(Box.Min, Box.Max);
+		return FVector::DistSquared(Closest, Sphere.Center) <= FMath::Square(Sphere.Radius);
+	}
+
+	// Two boxes, their bounds are the boxes themselves
+	return true;
+}
+
+
+//////////////////////////////////////////////////
+//////////////////////////////////////////////////
+UECSBroadphaseSystem::UECSBroadphaseSystem()
+{
+	TickFunction.TickGroup = ETickingGroup::TG_PostPhysics;
+}
+
+void UECSBroadphaseSystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+	if (UECSSystem* CopyTransformToActor = Cast<UECSSystem>(Collection.InitializeDependency(UECSCopyTransformToActor::StaticClass())))
+	{
+		AddSystemPrerequisite(*CopyTransformToActor);
+	}
+}
+
+void UECSBroadphaseSystem::RunSystem(float DeltaTime, ENamedThreads::Type CurrentThread) const
+{
+	Broadphase.Update(*Registry);
+	ReportProcessedEntities(Broadphase.GetNumShapes());
+}
@@ -0,0 +1,51 @@
+
+#include "ECSComponentTypes.h"
+
+TMap<entt::id_type, TUniquePtr<FECSComponentType>> FECSComponentTypes::Types;
+
+
+//////////////////////////////////////////////////
+const FECSComponentType& FECSComponentTypes::Add(FECSComponentType&& Type)
+{
+	checkf(!Find(Type.Name) || Find(Type.Name)->Id == Type.Id, TEXT("The component name %s is already used by another type"), *Type.Name.ToString());
+	
+	TUniquePtr<FECSComponentType>& Entry = Types.FindOrAdd(Type.Id);
+	Entry = MakeUnique<FECSComponentType>(MoveTemp(Type));
+	return *Entry;
+}
+
+//////////////////////////////////////////////////
+const FECSComponentType* FECSComponentTypes::Find(entt::id_type Id)
+{
+	const TUniquePtr<FECSComponentType>* Type = Types.Find(Id);
+	return Type ? Type->Get() : nullptr;
+}
+
+const FECSComponentType* FECSComponentTypes::Find(FName Name)
+{
+	for (const TPair<entt::id_type, TUniquePtr<FECSComponentType>>& Pair : Types)
+	{
+		if (Pair.Value->Name == Name)
+		{
+			return Pair.Value.Get();
+		}
+	}
+	return nullptr;
+}
+
+TArray<const FECSComponentType*> FECSComponentTypes::GetAll()
+{
+	TArray<const FECSComponentType*> Result;
+	Result.Reserve(Types.Num());
+	for (const TPair<entt::id_type, TUniquePtr<FECSComponentType>>& Pair : Types)
+	{
+		Result.Add(Pair.Value.Get());
+	}
+	return Result;
+}
+
+//////////////////////////////////////////////////
+void FECSComponentTypes::Reset()
+{
+	Types.Empty();
+}
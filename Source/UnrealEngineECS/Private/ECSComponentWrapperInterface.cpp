@@ -1,5 +1,15 @@
 
 #include "ECSComponentWrapperInterface.h"
+#include "HAL/IConsoleManager.h"
+
+static TAutoConsoleVariable<int32> CVarBatchRegistration(
+	TEXT("ecs.BatchRegistration"),
+	1,
+	TEXT("ECS component wrappers that are registered in a batch at the start of the next world tick after their BeginPlay:\n")
+	TEXT("0: None, they are registered immediately in BeginPlay.\n")
+	TEXT("1: Those that begin play with the level, on level load and level streaming. Spawned actors are registered immediately.\n")
+	TEXT("2: All of them."),
+	ECVF_Default);
 
 
 void UECSComponentWrapper::RegisterComponentWithECS()
@@ -11,8 +21,27 @@ void UECSComponentWrapper::RegisterComponentWithECS()
 	}
 }
 
+const FEntity& UECSComponentWrapper::GetEntityHandle()
+{
+	if (!IsRegisteredWithECS() && UECSRegistry::HasRegistry())
+	{
+		UECSRegistry::GetRegistry().RegisterImmediately(this);
+	}
+	return EntityHandle;
+}
+
 void UECSComponentWrapper::BeginPlay()
 {
 	Super::BeginPlay();
-	RegisterComponentWithECS();
+
+	const int32 BatchRegistration = CVarBatchRegistration.GetValueOnGameThread();
+	const bool bLevelLoad = !GetWorld()->HasBegunPlay() || GetOwner()->IsActorBeginningPlayFromLevelStreaming();
+	if (BatchRegistration == 2 || (BatchRegistration == 1 && bLevelLoad))
+	{
+		UECSRegistry::GetRegistry().EnqueueRegistration(this);
+	}
+	else
+	{
+		RegisterComponentWithECS();
+	}
 }
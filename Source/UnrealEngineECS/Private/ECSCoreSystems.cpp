@@ -1,6 +1,7 @@
 ﻿
 #include "ECSCoreSystems.h"
 #include "UEEnTTComponents.h"
+#include "ECSTransformKernels.h"
 #include "GameFramework/Actor.h"
 
 DECLARE_CYCLE_STAT(TEXT("Copy transforms from ECS to actors"), STAT_CopyTransformToActor, STATGROUP_ECS);
@@ -14,39 +15,24 @@ UECSCopyTransformToECS::UECSCopyTransformToECS()
 	TickFunction.TickGroup = ETickingGroup::TG_PrePhysics;
 }
 
-//////////////////////////////////////////////////
-void UECSCopyTransformToECS::Initialize(FSubsystemCollectionBase& Collection)
-{
-	Super::Initialize(Collection);
-
-	// Connect an observer to the registry, which listens for entities with a transform, actor ptr and sync transform component 
-	Observer.Connect(*Registry, ECS::Collector.update<FTransform>().where<FActorPtrComponent, FSyncTransformToECS>());
-}
-
-void UECSCopyTransformToECS::Deinitialize()
-{
-	Super::Deinitialize();
-	Observer.Disconnect();
-}
-
 //////////////////////////////////////////////////
 void UECSCopyTransformToECS::RunSystem(float DeltaTime, ENamedThreads::Type CurrentThread) const
 {
 	SCOPE_CYCLE_COUNTER(STAT_CopyTransformToECS);
 
-	// auto View = Registry->View<FActorPtrComponent, FTransform, FSyncTransformToECS>();	
-	// for (auto&& [Entity, Actor, Transform, SyncComp] : View.each())
-	// {
-	// 	Transform = Actor->GetActorTransform();
-	// 	SyncComp.bSyncTransform = false;
-	// }
+	// The tag pool is the smallest set of candidates, so only entities whose actor moved are visited. Entities whose sync was
+	// switched off in the meantime are skipped, their FSyncTransformToECS is disabled.
+	// The split components are updated too, otherwise UECSCopyTransformToActor would pack their old values back into the transform
+	entt::registry& EnTTRegistry = Registry->GetEntTTReg();
+	Registry->EachEnabled(Registry->View<FActorPtrComponent, FTransform, FActorTransformChanged, FSyncTransformToECS>(),
+		[&EnTTRegistry](entt::entity Entity, FActorPtrComponent& Actor, FTransform& Transform)
+		{
+			Transform = Actor->GetActorTransform();
+			ECS::Kernels::UnpackTransform(EnTTRegistry, Entity, Transform);
+		});
 
-	Observer.Each([&](const auto Entity)
-	{
-		auto&& [Actor, Transform, SyncComp] = Registry->GetEntTTReg().get<FActorPtrComponent, FTransform, FSyncTransformToECS>(Entity);
-		Transform = Actor->GetActorTransform();
-        SyncComp.bSyncTransform = false;
-	});
+	ReportProcessedEntities(Registry->Size<FActorTransformChanged>());
+	Registry->ClearTag<FActorTransformChanged>();
 }
 
 
@@ -60,13 +46,18 @@ UECSCopyTransformToActor::UECSCopyTransformToActor()
 void UECSCopyTransformToActor::RunSystem(float DeltaTime, ENamedThreads::Type CurrentThread) const
 {
 	SCOPE_CYCLE_COUNTER(STAT_CopyTransformToActor);
+
+	// Systems may only have written the split transform components, so rebuild the full transforms first
+	ECS::Kernels::PackTransforms(*Registry);
 	
-	auto View = Registry->View<FActorPtrComponent, FTransform, FSyncTransformToActor>();
-	for (auto&& [Entity, Actor, Transform, SyncComp] : View.each())
+	// The group keeps actors and transforms packed. The sync settings are shared, there are only a few distinct values to look up
+	const TECSSharedStore<FSyncTransformToActor>& SyncSettings = Registry->Shared<FSyncTransformToActor>();
+	auto Group = Registry->Group<FActorPtrComponent, FTransform, TECSShared<FSyncTransformToActor>>();
+	Registry->EachEnabled(Group, [&SyncSettings](entt::entity Entity, FActorPtrComponent& Actor, FTransform& Transform,
+												 TECSShared<FSyncTransformToActor>& Shared)
 	{
-		if (SyncComp.bSyncTransform)
-		{
-			Actor->SetActorTransform(Transform, SyncComp.bSweep, nullptr, SyncComp.TeleportType);			
-		}
-	}
+		const FSyncTransformToActor& SyncComp = SyncSettings.Get(Shared.GetIndex());
+		Actor->SetActorTransform(Transform, SyncComp.bSweep, nullptr, SyncComp.TeleportType);
+	});
+	ReportProcessedEntities(Group.size());
 }
@@ -0,0 +1,281 @@
+
+#include "ECSEntityImporter.h"
+#include "ECSComponentTypes.h"
+#include "UnrealEngineECS.h"
+#include "HAL/PlatformFilemanager.h"
+#include "UObject/UnrealType.h"
+
+DECLARE_CYCLE_STAT(TEXT("Import entities"), STAT_ImportEntities, STATGROUP_ECS);
+
+
+//////////////////////////////////////////////////
+FECSEntityImporter::FECSEntityImporter(IECSRegistryInterface& Registry, const FECSImportSettings& Settings)
+	: Registry(Registry), Settings(Settings)
+{
+}
+
+FECSEntityImporter::~FECSEntityImporter()
+{
+	Close();
+}
+
+//////////////////////////////////////////////////
+bool FECSEntityImporter::Open(const FString& InFilePath, bool bInTickAutomatically)
+{
+	Close();
+	FilePath = InFilePath;
+	bTickAutomatically = bInTickAutomatically;
+	bEndOfFile = false;
+	NumImported = 0;
+	
+	File.Reset(FPlatformFileManager::Get().GetPlatformFile().OpenRead(*FilePath));
+	if (!File.IsValid())
+	{
+		UE_LOG(LogUnrealECS, Error, TEXT("Could not open %s for import"), *FilePath);
+		return false;
+	}
+
+	// Read until we have the header
+	while (PendingRows.Num() == 0 && ReadChunk())
+	{
+	}
+
+	if (PendingRows.Num() == 0)
+	{
+		UE_LOG(LogUnrealECS, Error, TEXT("%s has no header"), *FilePath);
+		Close();
+		return false;
+	}
+
+	const TArray<FString> Header = PendingRows[0];
+	PendingRows.RemoveAt(0);
+
+	for (const FString& ColumnName : Header)
+	{
+		FString TypeName, PropertyName;
+		if (!ColumnName.Split(TEXT("."), &TypeName, &PropertyName))
+		{
+			TypeName = ColumnName;
+		}
+
+		const FECSComponentType* Type = FECSComponentTypes::Find(FName(*TypeName));
+		if (!Type || !Type->Struct)
+		{
+			UE_LOG(LogUnrealECS, Error, TEXT("%s: Column %s references the unknown component %s"), *FilePath, *ColumnName, *TypeName);
+			Close();
+			return false;
+		}
+
+		FColumn Column;
+		Column.ComponentIndex = Components.AddUnique(Type);
+		if (!PropertyName.IsEmpty())
+		{
+			Column.Property = FindFProperty<FProperty>(Type->Struct, *PropertyName);
+			if (!Column.Property)
+			{
+				UE_LOG(LogUnrealECS, Error, TEXT("%s: %s has no property %s"), *FilePath, *TypeName, *PropertyName);
+				Close();
+				return false;
+			}
+		}
+		Columns.Add(Column);
+	}
+
+	return true;
+}
+
+void FECSEntityImporter::Close()
+{
+	File.Reset();
+	Components.Reset();
+	Columns.Reset();
+	PendingBytes.Reset();
+	PendingRows.Reset();
+	bEndOfFile = true;
+}
+
+//////////////////////////////////////////////////
+bool FECSEntityImporter::Import(double TimeBudgetSeconds)
+{
+	SCOPE_CYCLE_COUNTER(STAT_ImportEntities);
+
+	const double EndTime = FPlatformTime::Seconds() + TimeBudgetSeconds;
+	while (!IsDone() && FPlatformTime::Seconds() < EndTime)
+	{
+		if (PendingRows.Num() < FMath::Max(Settings.BatchSize, 1) && !bEndOfFile)
+		{
+			ReadChunk();
+		}
+		else
+		{
+			CreateBatch();
+		}
+	}
+
+	if (IsDone() && File.IsValid())
+	{
+		UE_LOG(LogUnrealECS, Log, TEXT("Imported %d entities from %s"), NumImported, *FilePath);
+		Close();
+		OnFinished.Broadcast();
+	}
+	
+	return IsDone();
+}
+
+bool FECSEntityImporter::IsDone() const
+{
+	return bEndOfFile && PendingRows.Num() == 0;
+}
+
+//////////////////////////////////////////////////
+bool FECSEntityImporter::ReadChunk()
+{
+	const int32 BytesToRead = static_cast<int32>(FMath::Min<int64>(Settings.ChunkSize, File->Size() - File->Tell()));
+	bEndOfFile = BytesToRead <= 0;
+
+	const int32 Offset = PendingBytes.Num();
+	if (!bEndOfFile)
+	{
+		PendingBytes.AddUninitialized(BytesToRead);
+		if (!File->Read(reinterpret_cast<uint8*>(PendingBytes.GetData() + Offset), BytesToRead))
+		{
+			UE_LOG(LogUnrealECS, Error, TEXT("Failed to read from %s"), *FilePath);
+			PendingBytes.SetNum(Offset);
+			bEndOfFile = true;
+		}
+	}
+
+	// Split the complete lines off. At the end of the file, the remaining bytes are the last line
+	int32 LineStart = 0;
+	for (int32 Index = 0; Index < PendingBytes.Num(); ++Index)
+	{
+		const bool bLastByte = bEndOfFile && Index == PendingBytes.Num() - 1;
+		if (PendingBytes[Index] == '\n' || bLastByte)
+		{
+			const int32 LineEnd = PendingBytes[Index] == '\n' ? Index : Index + 1;
+			const FUTF8ToTCHAR Converted(PendingBytes.GetData() + LineStart, LineEnd - LineStart);
+			FString Line(Converted.Length(), Converted.Get());
+			Line.TrimEndInline();
+			if (!Line.IsEmpty())
+			{
+				ParseLine(Line, PendingRows.AddDefaulted_GetRef());
+			}
+			LineStart = Index + 1;
+		}
+	}
+	PendingBytes.RemoveAt(0, FMath::Min(LineStart, PendingBytes.Num()), false);
+
+	return !bEndOfFile;
+}
+
+void FECSEntityImporter::ParseLine(const FString& Line, TArray<FString>& OutFields)
+{
+	FString Field;
+	bool bQuoted = false;
+	for (int32 Index = 0; Index < Line.Len(); ++Index)
+	{
+		const TCHAR Char = Line[Index];
+		if (Char == TEXT('"'))
+		{
+			// Two quotes inside a quoted field are an escaped quote
+			if (bQuoted && Index + 1 < Line.Len() && Line[Index + 1] == TEXT('"'))
+			{
+				Field.AppendChar(Char);
+				++Index;
+			}
+			else
+			{
+				bQuoted = !bQuoted;
+			}
+		}
+		else if (Char == TEXT(',') && !bQuoted)
+		{
+			OutFields.Add(MoveTemp(Field));
+			Field.Reset();
+		}
+		else
+		{
+			Field.AppendChar(Char);
+		}
+	}
+	OutFields.Add(MoveTemp(Field));
+}
+
+//////////////////////////////////////////////////
+void FECSEntityImporter::CreateBatch()
+{
+	const int32 NumRows = FMath::Min(PendingRows.Num(), FMath::Max(Settings.BatchSize, 1));
+	if (NumRows == 0)
+	{
+		return;
+	}
+
+	// Convert the rows to components, one packed buffer per component type
+	TArray<void*, TInlineAllocator<8>> Buffers;
+	for (const FECSComponentType* Type : Components)
+	{
+		const int32 Stride = Type->Struct->GetStructureSize();
+		void* Buffer = FMemory::Malloc(Stride * NumRows, Type->Struct->GetMinAlignment());
+		Type->Struct->InitializeStruct(Buffer, NumRows);
+		Buffers.Add(Buffer);
+	}
+
+	for (int32 Row = 0; Row < NumRows; ++Row)
+	{
+		const TArray<FString>& Fields = PendingRows[Row];
+		for (int32 ColumnIndex = 0; ColumnIndex < FMath::Min(Fields.Num(), Columns.Num()); ++ColumnIndex)
+		{
+			if (Fields[ColumnIndex].IsEmpty())
+			{
+				continue;
+			}
+			
+			const FColumn& Column = Columns[ColumnIndex];
+			UScriptStruct* Struct = Components[Column.ComponentIndex]->Struct;
+			uint8* Instance = static_cast<uint8*>(Buffers[Column.ComponentIndex]) + Row * Struct->GetStructureSize();
+
+			const TCHAR* Result = Column.Property
+				? Column.Property->ImportText(*Fields[ColumnIndex], Column.Property->ContainerPtrToValuePtr<void>(Instance), PPF_None, nullptr)
+				: Struct->ImportText(*Fields[ColumnIndex], Instance, nullptr, PPF_None, nullptr, Struct->GetName());
+			
+			if (!Result)
+			{
+				UE_LOG(LogUnrealECS, Warning, TEXT("%s: Could not import \"%s\" in row %d"), *FilePath, *Fields[ColumnIndex], NumImported + Row + 1);
+			}
+		}
+	}
+
+	// Create all entities at once, then insert the components type by type
+	TArray<entt::entity> Entities;
+	Entities.SetNumUninitialized(NumRows);
+	Registry.Create(Entities);
+
+	for (int32 Index = 0; Index < Components.Num(); ++Index)
+	{
+		const FECSComponentType* Type = Components[Index];
+		Type->Reserve(Registry, NumRows);
+		Type->Insert(Registry, Entities.GetData(), Buffers[Index], NumRows);
+		
+		Type->Struct->DestroyStruct(Buffers[Index], NumRows);
+		FMemory::Free(Buffers[Index]);
+	}
+
+	PendingRows.RemoveAt(0, NumRows, false);
+	NumImported += NumRows;
+}
+
+//////////////////////////////////////////////////
+void FECSEntityImporter::Tick(float DeltaTime)
+{
+	Import(Settings.TimeBudgetMs / 1000.0);
+}
+
+bool FECSEntityImporter::IsTickable() const
+{
+	return bTickAutomatically && File.IsValid();
+}
+
+TStatId FECSEntityImporter::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(FECSEntityImporter, STATGROUP_ECS);
+}
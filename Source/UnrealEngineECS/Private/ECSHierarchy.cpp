@@ -0,0 +1,233 @@
+
+#include "ECSHierarchy.h"
+#include "UnrealEngineECS.h"
+
+
+//////////////////////////////////////////////////
+void ECS::Hierarchy::Detach(IECSRegistryInterface& Registry, FEntityId Entity)
+{
+	entt::registry& EnTTRegistry = Registry.GetEntTTReg();
+	FRelationship* Relationship = EnTTRegistry.try_get<FRelationship>(Entity.GetHandle());
+	if (!Relationship || !Relationship->Parent)
+	{
+		return;
+	}
+
+	if (Relationship->Prev)
+	{
+		EnTTRegistry.get<FRelationship>(Relationship->Prev.GetHandle()).Next = Relationship->Next;
+	}
+	else
+	{
+		EnTTRegistry.get<FRelationship>(Relationship->Parent.GetHandle()).First = Relationship->Next;
+	}
+
+	if (Relationship->Next)
+	{
+		EnTTRegistry.get<FRelationship>(Relationship->Next.GetHandle()).Prev = Relationship->Prev;
+	}
+
+	Relationship->Parent = FEntityId::NullId;
+	Relationship->Prev = FEntityId::NullId;
+	Relationship->Next = FEntityId::NullId;
+}
+
+//////////////////////////////////////////////////
+void ECS::Hierarchy::Reparent(IECSRegistryInterface& Registry, TArrayView<const FEntityId> Entities, FEntityId NewParent)
+{
+	entt::registry& EnTTRegistry = Registry.GetEntTTReg();
+
+	// Attaching an entity below itself would create a cycle, so the new parent must not be inside any of the moved subtrees
+	if (NewParent)
+	{
+		for (FEntityId Ancestor = NewParent; Ancestor;)
+		{
+			if (Entities.Contains(Ancestor))
+			{
+				UE_LOG(LogUnrealECS, Error, TEXT("Hierarchy: Can't reparent entity %u to %u, which is the entity itself or one of its descendants"),
+					   entt::to_integral(Ancestor.GetHandle()), entt::to_integral(NewParent.GetHandle()));
+				return;
+			}
+			const FRelationship* Relationship = EnTTRegistry.try_get<FRelationship>(Ancestor.GetHandle());
+			Ancestor = Relationship ? Relationship->Parent : FEntityId::NullId;
+		}
+	}
+
+	for (const FEntityId Entity : Entities)
+	{
+		Detach(Registry, Entity);
+	}
+
+	if (!NewParent || Entities.Num() == 0)
+	{
+		return;
+	}
+
+	// Emplace everything first, so the references we take afterwards stay valid
+	EnTTRegistry.get_or_emplace<FRelationship>(NewParent.GetHandle());
+	for (const FEntityId Entity : Entities)
+	{
+		EnTTRegistry.get_or_emplace<FRelationship>(Entity.GetHandle());
+	}
+
+	FRelationship& ParentRelationship = EnTTRegistry.get<FRelationship>(NewParent.GetHandle());
+	FEntityId Prev = ParentRelationship.LastChild(Registry);
+
+	for (const FEntityId Entity : Entities)
+	{
+		FRelationship& Relationship = EnTTRegistry.get<FRelationship>(Entity.GetHandle());
+		Relationship.Parent = NewParent;
+		Relationship.Prev = Prev;
+
+		if (Prev)
+		{
+			EnTTRegistry.get<FRelationship>(Prev.GetHandle()).Next = Entity;
+		}
+		else
+		{
+			ParentRelationship.First = Entity;
+		}
+		Prev = Entity;
+	}
+}
+
+//////////////////////////////////////////////////
+void ECS::Hierarchy::GetDescendants(IECSRegistryInterface& Registry, FEntityId Entity, TArray<entt::entity>& OutDescendants)
+{
+	entt::registry& EnTTRegistry = Registry.GetEntTTReg();
+
+	// Breadth first: Every entity we add is later visited for its own children
+	int32 Index = OutDescendants.Num();
+	const FRelationship* Relationship = EnTTRegistry.try_get<FRelationship>(Entity.GetHandle());
+	while (true)
+	{
+		for (FEntityId Child = Relationship ? Relationship->First : FEntityId::NullId; Child;
+			 Child = EnTTRegistry.get<FRelationship>(Child.GetHandle()).Next)
+		{
+			OutDescendants.Add(Child.GetHandle());
+		}
+
+		if (Index >= OutDescendants.Num())
+		{
+			break;
+		}
+		Relationship = &EnTTRegistry.get<FRelationship>(OutDescendants[Index++]);
+	}
+}
+
+int32 ECS::Hierarchy::DestroySubtrees(IECSRegistryInterface& Registry, TArrayView<const FEntityId> Roots)
+{
+	TArray<entt::entity> Entities;
+	TSet<FEntityId> Collected;
+	Entities.Reserve(Roots.Num());
+	
+	for (const FEntityId Root : Roots)
+	{
+		// Roots below an earlier root were already collected with its subtree. Destroying them twice would corrupt the registry
+		if (Collected.Contains(Root))
+		{
+			continue;
+		}
+
+		Detach(Registry, Root);
+		const int32 Begin = Entities.Add(Root.GetHandle());
+		GetDescendants(Registry, Root, Entities);
+		for (int32 Index = Begin; Index < Entities.Num(); ++Index)
+		{
+			Collected.Add(Entities[Index]);
+		}
+	}
+
+	Registry.Destroy(Entities);
+	return Entities.Num();
+}
+
+//////////////////////////////////////////////////
+int32 ECS::Hierarchy::ClearStaleLinks(IECSRegistryInterface& Registry)
+{
+	int32 NumCleared = 0;
+	const auto View = Registry.GetEntTTReg().view<FRelationship>();
+	ECS_TRACE_QUERY(View);
+	for (auto&& [Entity, Relationship] : View.each())
+	{
+		FEntityId Links[] = { Relationship.First, Relationship.Prev, Relationship.Next, Relationship.Parent };
+		const int32 NumStale = Registry.ClearStaleHandles(Links);
+		if (NumStale > 0)
+		{
+			Relationship.First = Links[0];
+			Relationship.Prev = Links[1];
+			Relationship.Next = Links[2];
+			Relationship.Parent = Links[3];
+			NumCleared += NumStale;
+		}
+	}
+	return NumCleared;
+}
+
+//////////////////////////////////////////////////
+bool ECS::Hierarchy::Validate(IECSRegistryInterface& Registry)
+{
+	entt::registry& EnTTRegistry = Registry.GetEntTTReg();
+	bool bValid = true;
+
+	auto IsLinkValid = [&](entt::entity Entity, FEntityId Link, const TCHAR* LinkName)
+	{
+		if (Link && (!EnTTRegistry.valid(Link.GetHandle()) || !EnTTRegistry.has<FRelationship>(Link.GetHandle())))
+		{
+			UE_LOG(LogUnrealECS, Error, TEXT("Hierarchy: %s of entity %u references %u, which doesn't exist or has no relationship"),
+				   LinkName, entt::to_integral(Entity), entt::to_integral(Link.GetHandle()));
+			bValid = false;
+			return false;
+		}
+		return Link.operator bool();
+	};
+
+	for (auto&& [Entity, Relationship] : EnTTRegistry.view<const FRelationship>().each())
+	{
+		const FEntityId Self(Entity);
+		
+		if (IsLinkValid(Entity, Relationship.First, TEXT("First")))
+		{
+			const FRelationship& First = EnTTRegistry.get<FRelationship>(Relationship.First.GetHandle());
+			if (First.Prev || First.Parent != Self)
+			{
+				UE_LOG(LogUnrealECS, Error, TEXT("Hierarchy: First child %u of entity %u has a previous sibling or another parent"),
+					   entt::to_integral(Relationship.First.GetHandle()), entt::to_integral(Entity));
+				bValid = false;
+			}
+		}
+
+		if (IsLinkValid(Entity, Relationship.Next, TEXT("Next")))
+		{
+			const FRelationship& Next = EnTTRegistry.get<FRelationship>(Relationship.Next.GetHandle());
+			if (Next.Prev != Self || Next.Parent != Relationship.Parent)
+			{
+				UE_LOG(LogUnrealECS, Error, TEXT("Hierarchy: Next sibling %u of entity %u doesn't link back or has another parent"),
+					   entt::to_integral(Relationship.Next.GetHandle()), entt::to_integral(Entity));
+				bValid = false;
+			}
+		}
+
+		if (IsLinkValid(Entity, Relationship.Prev, TEXT("Prev")))
+		{
+			if (EnTTRegistry.get<FRelationship>(Relationship.Prev.GetHandle()).Next != Self)
+			{
+				UE_LOG(LogUnrealECS, Error, TEXT("Hierarchy: Previous sibling %u of entity %u doesn't link back"),
+					   entt::to_integral(Relationship.Prev.GetHandle()), entt::to_integral(Entity));
+				bValid = false;
+			}
+		}
+
+		if (IsLinkValid(Entity, Relationship.Parent, TEXT("Parent")) && !Relationship.Prev)
+		{
+			if (EnTTRegistry.get<FRelationship>(Relationship.Parent.GetHandle()).First != Self)
+			{
+				UE_LOG(LogUnrealECS, Error, TEXT("Hierarchy: Entity %u has no previous sibling, but isn't the first child of its parent %u"),
+					   entt::to_integral(Entity), entt::to_integral(Relationship.Parent.GetHandle()));
+				bValid = false;
+			}
+		}
+	}
+
+	return bValid;
+}
@@ -0,0 +1,154 @@
+
+#include "ECSMigration.h"
+#include "ECSComponentTypes.h"
+#include "ECSHierarchy.h"
+#include "UnrealEngineECS.h"
+
+DECLARE_CYCLE_STAT(TEXT("Migrate entities"), STAT_MigrateEntities, STATGROUP_ECS);
+
+
+namespace
+{
+	/** Source and target entities of one component type */
+	struct FMigrationBatch
+	{
+		TArray<entt::entity> SourceEntities;
+		TArray<entt::entity> TargetEntities;
+	};
+}
+
+//////////////////////////////////////////////////
+TMap<FEntityId, FEntityId> ECS::MigrateEntities(IECSRegistryInterface& Source, IECSRegistryInterface& Target,
+												TArrayView<const entt::entity> Entities)
+{
+	SCOPE_CYCLE_COUNTER(STAT_MigrateEntities);
+#if ECS_WITH_QUERY_TRACE
+	static const ECS::Trace::FScopeName TraceName(TEXT("Migrate entities"));
+#endif
+	ECS_TRACE_SCOPE(TraceName, Entities.Num());
+	checkf(&Source != &Target, TEXT("Entities can only be migrated to another registry"));
+
+	entt::registry& SourceRegistry = Source.GetEntTTReg();
+	entt::registry& TargetRegistry = Target.GetEntTTReg();
+
+	// Index of each source entity in SourceEntities and TargetEntities
+	TMap<FEntityId, int32> Indices;
+	TArray<entt::entity> SourceEntities;
+	Indices.Reserve(Entities.Num());
+	SourceEntities.Reserve(Entities.Num());
+	for (const entt::entity Entity : Entities)
+	{
+		if (SourceRegistry.valid(Entity) && !Indices.Contains(Entity))
+		{
+			Indices.Add(Entity, SourceEntities.Add(Entity));
+		}
+	}
+
+	// Cut all links that leave the moved entities, so afterwards every link of a moved relationship can be remapped
+	TArray<FEntityId> ToDetach;
+	for (const entt::entity Entity : SourceEntities)
+	{
+		if (const FRelationship* Relationship = SourceRegistry.try_get<FRelationship>(Entity))
+		{
+			if (Relationship->Parent && !Indices.Contains(Relationship->Parent))
+			{
+				ToDetach.Add(Entity);
+			}
+			for (FEntityId Child = Relationship->First; Child; Child = SourceRegistry.get<FRelationship>(Child.GetHandle()).Next)
+			{
+				if (!Indices.Contains(Child))
+				{
+					ToDetach.Add(Child);
+				}
+			}
+		}
+	}
+	for (const FEntityId Entity : ToDetach)
+	{
+		Hierarchy::Detach(Source, Entity);
+	}
+
+	TArray<entt::entity> TargetEntities;
+	TargetEntities.SetNumUninitialized(SourceEntities.Num());
+	Target.Create(TargetEntities);
+
+	// Group the entities by component type, so each pool is filled in one go
+	TMap<entt::id_type, FMigrationBatch> Batches;
+	for (int32 Index = 0; Index < SourceEntities.Num(); ++Index)
+	{
+		SourceRegistry.visit(SourceEntities[Index], [&Batches, &SourceEntities, &TargetEntities, Index](const entt::id_type ComponentType)
+		{
+			FMigrationBatch& Batch = Batches.FindOrAdd(ComponentType);
+			Batch.SourceEntities.Add(SourceEntities[Index]);
+			Batch.TargetEntities.Add(TargetEntities[Index]);
+		});
+
+		if (!Source.IsEnabled(SourceEntities[Index]))
+		{
+			Target.SetEnabled(TargetEntities[Index], false);
+		}
+	}
+
+	auto Remap = [&Indices, &TargetEntities](const FEntityId Link)
+	{
+		const int32* Index = Link ? Indices.Find(Link) : nullptr;
+		return Index ? FEntityId(TargetEntities[*Index]) : FEntityId::NullId;
+	};
+
+	for (const TPair<entt::id_type, FMigrationBatch>& Pair : Batches)
+	{
+		const FMigrationBatch& Batch = Pair.Value;
+		const int32 Count = Batch.SourceEntities.Num();
+
+		// Carry over disabled components
+		for (int32 Index = 0; Index < Count; ++Index)
+		{
+			if (!Source.IsComponentEnabled(Pair.Key, Batch.SourceEntities[Index]))
+			{
+				Target.SetComponentEnabled(Pair.Key, Batch.TargetEntities[Index], false);
+			}
+		}
+
+		if (Pair.Key == TypeId<FRelationship>())
+		{
+			TArray<FRelationship> Relationships;
+			Relationships.Reserve(Count);
+			for (const entt::entity Entity : Batch.SourceEntities)
+			{
+				const FRelationship& Relationship = SourceRegistry.get<FRelationship>(Entity);
+				FRelationship& Remapped = Relationships.AddDefaulted_GetRef();
+				Remapped.First = Remap(Relationship.First);
+				Remapped.Prev = Remap(Relationship.Prev);
+				Remapped.Next = Remap(Relationship.Next);
+				Remapped.Parent = Remap(Relationship.Parent);
+			}
+			TargetRegistry.insert<FRelationship>(Batch.TargetEntities.GetData(), Batch.TargetEntities.GetData() + Count,
+												 Relationships.GetData(), Relationships.GetData() + Count);
+			continue;
+		}
+
+		const FECSComponentType* Type = FECSComponentTypes::Find(Pair.Key);
+		if (Type && Type->Move)
+		{
+			Type->Move(Source, Target, Batch.SourceEntities.GetData(), Batch.TargetEntities.GetData(), Count);
+		}
+		else
+		{
+			// Only tracked pools know the name of their type
+			const FString PoolName = Source.GetStats().FindPoolName(Pair.Key);
+			const FString TypeName = PoolName.IsEmpty() ? FString::Printf(TEXT("type %u"), Pair.Key) : PoolName;
+			UE_LOG(LogUnrealECS, Warning, TEXT("MigrateEntities: Dropped %d components of %s, which isn't registered in FECSComponentTypes"),
+				   Count, *TypeName);
+		}
+	}
+
+	TMap<FEntityId, FEntityId> Mapping;
+	Mapping.Reserve(SourceEntities.Num());
+	for (int32 Index = 0; Index < SourceEntities.Num(); ++Index)
+	{
+		Mapping.Add(SourceEntities[Index], TargetEntities[Index]);
+	}
+
+	Source.Destroy(SourceEntities);
+	return Mapping;
+}
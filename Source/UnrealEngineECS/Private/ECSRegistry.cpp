@@ -1,24 +1,185 @@
 ﻿
 #include "ECSRegistry.h"
 #include "UEEnTTEntity.h"
+#include "UEEnTTComponents.h"
+#include "ECSComponentWrapperInterface.h"
+#include "ECSReplay.h"
+#include "ECSComponentTypes.h"
+#include "Engine/World.h"
+#include "Engine/GameInstance.h"
+#include "UnrealEngineECS.h"
+
+DECLARE_CYCLE_STAT(TEXT("Flush entity registrations"), STAT_FlushRegistrations, STATGROUP_ECS);
+DECLARE_CYCLE_STAT(TEXT("Publish snapshots"), STAT_PublishSnapshots, STATGROUP_ECS);
 
 //////////////////////////////////////////////////
-inline FEntity IECSRegistryInterface::Create()
+IECSRegistryInterface::~IECSRegistryInterface()
+{
+	DisconnectObservers();
+}
+
+void IECSRegistryInterface::DisconnectObservers()
+{
+	// Disconnecting removes the observer from the list
+	while (Observers.Num() > 0)
+	{
+		Observers.Last()->Disconnect();
+	}
+}
+
+//////////////////////////////////////////////////
+FEntity IECSRegistryInterface::Create()
 {
 	FEntity NewEntity = FEntity(Registry.create(), *this);
+	if (Recorder)
+	{
+		Recorder->RecordCreate(NewEntity.EntityHandle);
+	}
 	return NewEntity;
 }
 
-inline FEntity IECSRegistryInterface::Create(FEntity Hint)
+FEntity IECSRegistryInterface::Create(FEntity Hint)
 {
 	FEntity NewEntity = FEntity(Registry.create(Hint.EntityHandle), *this);
+	if (Recorder)
+	{
+		Recorder->RecordCreate(NewEntity.EntityHandle);
+	}
 	return NewEntity;
 }
 
+void IECSRegistryInterface::Create(TArrayView<entt::entity> OutEntities)
+{
+	Registry.create(OutEntities.GetData(), OutEntities.GetData() + OutEntities.Num());
+	if (Recorder)
+	{
+		for (const entt::entity Entity : OutEntities)
+		{
+			Recorder->RecordCreate(Entity);
+		}
+	}
+}
+
 //////////////////////////////////////////////////
-inline void IECSRegistryInterface::Destroy(FEntity Entity)
+void IECSRegistryInterface::Destroy(FEntity Entity)
 {
+	ClearDisabled(Entity.EntityHandle);
 	Registry.destroy(Entity.EntityHandle);
+	if (Recorder)
+	{
+		Recorder->RecordDestroy(Entity.EntityHandle);
+	}
+}
+
+void IECSRegistryInterface::Destroy(TArrayView<const entt::entity> Entities)
+{
+	for (const entt::entity Entity : Entities)
+	{
+		ClearDisabled(Entity);
+	}
+	Registry.destroy(Entities.GetData(), Entities.GetData() + Entities.Num());
+	if (Recorder)
+	{
+		for (const entt::entity Entity : Entities)
+		{
+			Recorder->RecordDestroy(Entity);
+		}
+	}
+}
+
+void IECSRegistryInterface::ClearDisabled(const entt::entity Entity)
+{
+	DisabledEntities.Remove(Entity);
+	for (TPair<entt::id_type, TUniquePtr<FECSDisabledSet>>& Disabled : DisabledComponents)
+	{
+		Disabled.Value->Remove(Entity);
+	}
+}
+
+//////////////////////////////////////////////////
+bool IECSRegistryInterface::IsValid(FEntityId Entity) const
+{
+	return Registry.valid(Entity.GetHandle());
+}
+
+int32 IECSRegistryInterface::ValidateHandles(TArrayView<const FEntityId> Entities, TBitArray<>& OutValid) const
+{
+	OutValid.Init(false, Entities.Num());
+	
+	int32 NumInvalid = 0;
+	for (int32 Index = 0; Index < Entities.Num(); ++Index)
+	{
+		const bool bValid = Registry.valid(Entities[Index].GetHandle());
+		OutValid[Index] = bValid;
+		NumInvalid += bValid ? 0 : 1;
+	}
+	return NumInvalid;
+}
+
+int32 IECSRegistryInterface::ClearStaleHandles(TArrayView<FEntityId> Entities) const
+{
+	int32 NumCleared = 0;
+	for (FEntityId& Entity : Entities)
+	{
+		if (Entity && !Registry.valid(Entity.GetHandle()))
+		{
+			Entity = FEntityId::NullId;
+			++NumCleared;
+		}
+	}
+	return NumCleared;
+}
+
+
+//////////////////////////////////////////////////
+void IECSRegistryInterface::FlushBatchedEvents()
+{
+	for (TPair<entt::id_type, TUniquePtr<FECSBatchedEventsBase>>& Events : EventBatches)
+	{
+		Events.Value->Flush();
+	}
+}
+
+//////////////////////////////////////////////////
+void IECSRegistryInterface::PublishSnapshots(const uint64 FrameNumber)
+{
+	if (Snapshots.Num() == 0)
+	{
+		return;
+	}
+
+	SCOPE_CYCLE_COUNTER(STAT_PublishSnapshots);
+	for (TPair<entt::id_type, TSharedPtr<FECSSnapshotBase, ESPMode::ThreadSafe>>& Snapshot : Snapshots)
+	{
+		Snapshot.Value->Publish(Registry, FrameNumber);
+	}
+}
+
+//////////////////////////////////////////////////
+void IECSRegistryInterface::ClaimOwnedPools(std::initializer_list<entt::id_type> Types, const TCHAR* Name)
+{
+	TArray<entt::id_type, TInlineAllocator<8>> SortedTypes(Types.begin(), Types.size());
+	SortedTypes.Sort();
+
+	for (const FOwnedPools& Claim : OwnedPools)
+	{
+		if (Claim.Types == SortedTypes)
+		{
+			return;
+		}
+
+		int32 NumShared = 0;
+		for (const entt::id_type Type : SortedTypes)
+		{
+			NumShared += Claim.Types.Contains(Type) ? 1 : 0;
+		}
+
+		const bool bNested = NumShared == SortedTypes.Num() || NumShared == Claim.Types.Num();
+		checkf(NumShared == 0 || bNested, TEXT("The group owning [%s] conflicts with the group [%s]. A pool can only be owned by one group, or by nested groups"),
+			   Name, *Claim.Name);
+	}
+
+	OwnedPools.Add({ SortedTypes, Name });
 }
 
 
@@ -30,23 +191,201 @@ void UECSRegistry::Initialize(FSubsystemCollectionBase& Collection)
 {
 	Super::Initialize(Collection);
 	RegistryPtr = this;
+
+	// Core groups. Their pools are packed, so the built-in systems iterate them without probing other pools
+	ReserveGroup<FActorPtrComponent, FTransform, TECSShared<FSyncTransformToActor>>(TEXT("Core: Copy transform to actor"));
+	ReserveGroup<FECSPosition, FECSVelocity>(TEXT("Core: Integrate velocity"));
+
+	// All registered types, including those of the game modules, and the core components that can't be registered
+	for (const FECSComponentType* Type : FECSComponentTypes::GetAll())
+	{
+		Type->TrackPool(Stats, GetEntTTReg());
+	}
+	Stats.TrackPool<FActorPtrComponent>(GetEntTTReg());
+	Stats.TrackPool<FActorTransformChanged>(GetEntTTReg());
+	Stats.TrackPool<FRelationship>(GetEntTTReg());
+
+	PostActorTickHandle = FWorldDelegates::OnWorldPostActorTick.AddUObject(this, &UECSRegistry::OnWorldPostActorTick);
+	TickStartHandle = FWorldDelegates::OnWorldTickStart.AddUObject(this, &UECSRegistry::OnWorldTickStart);
 }
 
 void UECSRegistry::Deinitialize()
 {
+	FWorldDelegates::OnWorldPostActorTick.Remove(PostActorTickHandle);
+	FWorldDelegates::OnWorldTickStart.Remove(TickStartHandle);
+	PendingRegistrations.Empty();
+	if (Recorder)
+	{
+		Recorder->Stop();
+	}
+	if (Player)
+	{
+		Player->Close();
+	}
+	DisconnectObservers();
 	RegistryPtr = nullptr;
 }
 
+//////////////////////////////////////////////////
+void UECSRegistry::OnWorldPostActorTick(UWorld* World, ELevelTick TickType, float DeltaTime)
+{
+	if (World->GetGameInstance() == GetGameInstance())
+	{
+		FlushBatchedEvents();
+		PublishSnapshots(GFrameCounter);
+		Stats.Tick(DeltaTime, GetEntTTReg());
+		if (Recorder)
+		{
+			Recorder->EndFrame(DeltaTime);
+		}
+	}
+}
+
+void UECSRegistry::OnWorldTickStart(UWorld* World, ELevelTick TickType, float DeltaTime)
+{
+	if (World->GetGameInstance() == GetGameInstance())
+	{
+		FlushRegistrations();
+	}
+}
+
+//////////////////////////////////////////////////
+void UECSRegistry::EnqueueRegistration(UECSComponentWrapper* Wrapper)
+{
+	PendingRegistrations.Add(Wrapper);
+}
+
+void UECSRegistry::FlushRegistrations()
+{
+	if (PendingRegistrations.Num() == 0)
+	{
+		return;
+	}
+	
+	SCOPE_CYCLE_COUNTER(STAT_FlushRegistrations);
+
+	TArray<UECSComponentWrapper*> Wrappers;
+	Wrappers.Reserve(PendingRegistrations.Num());
+	for (const TWeakObjectPtr<UECSComponentWrapper>& Wrapper : PendingRegistrations)
+	{
+		if (Wrapper.IsValid() && !Wrapper->IsRegisteredWithECS())
+		{
+			Wrappers.Add(Wrapper.Get());
+		}
+	}
+	PendingRegistrations.Reset();
+
+	RegisterWrappers(Wrappers);
+}
+
+void UECSRegistry::RegisterImmediately(UECSComponentWrapper* Wrapper)
+{
+	AActor* Owner = Wrapper->GetOwner();
+	if (!PendingRegistrations.Contains(Wrapper))
+	{
+		return;
+	}
+
+	// Take all queued wrappers of the actor along, so they still share one entity
+	TArray<UECSComponentWrapper*> Wrappers;
+	PendingRegistrations.RemoveAll([Owner, &Wrappers](const TWeakObjectPtr<UECSComponentWrapper>& Pending)
+	{
+		if (Pending.IsValid() && Pending->GetOwner() == Owner)
+		{
+			if (!Pending->IsRegisteredWithECS())
+			{
+				Wrappers.Add(Pending.Get());
+			}
+			return true;
+		}
+		return false;
+	});
+
+	RegisterWrappers(Wrappers);
+}
+
+void UECSRegistry::RegisterWrappers(TArray<UECSComponentWrapper*>& Wrappers)
+{
+	if (Wrappers.Num() == 0)
+	{
+		return;
+	}
+
+	// One entity per actor, all created at once
+	TMap<AActor*, int32> ActorToEntity;
+	for (UECSComponentWrapper* Wrapper : Wrappers)
+	{
+		if (!ActorToEntity.Contains(Wrapper->GetOwner()))
+		{
+			ActorToEntity.Add(Wrapper->GetOwner(), ActorToEntity.Num());
+		}
+	}
+
+	TArray<entt::entity> Entities;
+	Entities.SetNumUninitialized(ActorToEntity.Num());
+	Create(Entities);
+
+	for (UECSComponentWrapper* Wrapper : Wrappers)
+	{
+		Wrapper->EntityHandle = FEntity(Entities[ActorToEntity[Wrapper->GetOwner()]], *this);
+	}
+
+	// Register grouped by class, so each pool is reserved once and then filled in one go. Classes are ordered by their priority and
+	// then by their first wrapper in the queue, so the order doesn't change from run to run
+	TMap<UClass*, int32> ClassOrder;
+	for (UECSComponentWrapper* Wrapper : Wrappers)
+	{
+		if (!ClassOrder.Contains(Wrapper->GetClass()))
+		{
+			ClassOrder.Add(Wrapper->GetClass(), ClassOrder.Num());
+		}
+	}
+	Wrappers.StableSort([&ClassOrder](const UECSComponentWrapper& A, const UECSComponentWrapper& B)
+	{
+		const int32 PriorityA = A.GetRegistrationPriority();
+		const int32 PriorityB = B.GetRegistrationPriority();
+		return PriorityA != PriorityB ? PriorityA < PriorityB : ClassOrder[A.GetClass()] < ClassOrder[B.GetClass()];
+	});
+
+	for (int32 Start = 0; Start < Wrappers.Num();)
+	{
+		int32 End = Start + 1;
+		while (End < Wrappers.Num() && Wrappers[End]->GetClass() == Wrappers[Start]->GetClass())
+		{
+			++End;
+		}
+
+		Wrappers[Start]->ReserveECSComponents(*this, MakeArrayView(Wrappers).Slice(Start, End - Start));
+		for (int32 Index = Start; Index < End; ++Index)
+		{
+			Wrappers[Index]->RegisterComponentWithECS();
+		}
+		Start = End;
+	}
+}
+
 //////////////////////////////////////////////////
 UECSRegistry& UECSRegistry::GetRegistry()
 {
 	return *RegistryPtr;
 }
 
+bool UECSRegistry::HasRegistry()
+{
+	return RegistryPtr != nullptr;
+}
+
 
 //////////////////////////////////////////////////
 //////////////////////////////////////////////////
 void FECSObserver::Disconnect()
 {
-	Observer.disconnect();
+	// Only touches the EnTT registry while we are connected to it, it may be gone by now otherwise
+	if (ConnectedRegistry)
+	{
+		ConnectedRegistry->GetStats().UntrackBacklog(this);
+		ConnectedRegistry->Observers.RemoveSingleSwap(this, false);
+		ConnectedRegistry = nullptr;
+		Observer.disconnect();
+	}
 }
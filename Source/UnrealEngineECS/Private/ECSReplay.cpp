@@ -0,0 +1,425 @@
+
+#include "ECSReplay.h"
+#include "UnrealEngineECS.h"
+#include "HAL/FileManager.h"
+#include "HAL/IConsoleManager.h"
+#include "Misc/Paths.h"
+#include "Serialization/MemoryReader.h"
+
+DECLARE_CYCLE_STAT(TEXT("Write replay frame"), STAT_WriteReplayFrame, STATGROUP_ECS);
+DECLARE_CYCLE_STAT(TEXT("Replay frame"), STAT_ReplayFrame, STATGROUP_ECS);
+
+
+//////////////////////////////////////////////////
+FECSReplayRecorder::FECSReplayRecorder(IECSRegistryInterface& Registry)
+	: Registry(Registry), FrameWriter(FrameBuffer)
+{
+}
+
+FECSReplayRecorder::~FECSReplayRecorder()
+{
+	Stop();
+}
+
+//////////////////////////////////////////////////
+bool FECSReplayRecorder::Start(const FString& FilePath)
+{
+	Stop();
+	if (Registry.Recorder)
+	{
+		UE_LOG(LogUnrealECS, Error, TEXT("The registry is already being recorded"));
+		return false;
+	}
+
+	File.Reset(IFileManager::Get().CreateFileWriter(*FilePath));
+	if (!File.IsValid())
+	{
+		UE_LOG(LogUnrealECS, Error, TEXT("Could not create %s"), *FilePath);
+		return false;
+	}
+
+	uint32 Magic = FileMagic;
+	uint32 Version = FileVersion;
+	*File << Magic << Version;
+
+	for (const FECSComponentType* Type : FECSComponentTypes::GetAll())
+	{
+		if (!Type->CanSerialize())
+		{
+			UE_LOG(LogUnrealECS, Warning, TEXT("%s can't be serialized and is not recorded"), *Type->Name.ToString());
+			continue;
+		}
+		Type->Connect(Registry.GetEntTTReg(), *this);
+		Types.Add(Type);
+	}
+
+	// The recording may start in a running session, so the replay has to begin with everything that already exists
+	WriteKeyframe();
+
+	Registry.Recorder = this;
+	UE_LOG(LogUnrealECS, Display, TEXT("Recording ECS replay to %s"), *FilePath);
+	return true;
+}
+
+void FECSReplayRecorder::Stop()
+{
+	if (!File.IsValid())
+	{
+		return;
+	}
+
+	for (const FECSComponentType* Type : Types)
+	{
+		Type->Disconnect(Registry.GetEntTTReg(), *this);
+	}
+	Types.Reset();
+	Registry.Recorder = nullptr;
+
+	// The records of the unfinished frame are dropped, the player only applies complete frames
+	FrameBuffer.Reset();
+	FrameWriter.Seek(0);
+	TypeIndices.Reset();
+
+	File->Close();
+	File.Reset();
+}
+
+void FECSReplayRecorder::WriteKeyframe()
+{
+	TSet<entt::id_type> RecordedTypes;
+	for (const FECSComponentType* Type : Types)
+	{
+		RecordedTypes.Add(Type->Id);
+	}
+
+	const entt::registry& EnTTRegistry = Registry.GetEntTTReg();
+	EnTTRegistry.each([this, &EnTTRegistry, &RecordedTypes](const entt::entity Entity)
+	{
+		RecordCreate(Entity);
+		EnTTRegistry.visit(Entity, [this, &RecordedTypes, Entity](const entt::id_type Type)
+		{
+			if (RecordedTypes.Contains(Type))
+			{
+				RecordValue(EECSReplayRecord::Emplace, Type, Entity);
+			}
+		});
+	});
+}
+
+//////////////////////////////////////////////////
+void FECSReplayRecorder::EndFrame(float DeltaTime)
+{
+	if (!File.IsValid())
+	{
+		return;
+	}
+
+	SCOPE_CYCLE_COUNTER(STAT_WriteReplayFrame);
+	uint8 Record = static_cast<uint8>(EECSReplayRecord::Frame);
+	FrameWriter << Record << DeltaTime;
+
+	File->Serialize(FrameBuffer.GetData(), FrameBuffer.Num());
+	FrameBuffer.Reset();
+	FrameWriter.Seek(0);
+}
+
+//////////////////////////////////////////////////
+void FECSReplayRecorder::RecordCreate(entt::entity Entity)
+{
+	uint8 Record = static_cast<uint8>(EECSReplayRecord::Create);
+	uint32 Id = entt::to_integral(Entity);
+	FrameWriter << Record << Id;
+}
+
+void FECSReplayRecorder::RecordDestroy(entt::entity Entity)
+{
+	uint8 Record = static_cast<uint8>(EECSReplayRecord::Destroy);
+	uint32 Id = entt::to_integral(Entity);
+	FrameWriter << Record << Id;
+}
+
+//////////////////////////////////////////////////
+void FECSReplayRecorder::OnComponentConstructed(entt::id_type Type, entt::registry& EnTTRegistry, entt::entity Entity)
+{
+	RecordValue(EECSReplayRecord::Emplace, Type, Entity);
+}
+
+void FECSReplayRecorder::OnComponentUpdated(entt::id_type Type, entt::registry& EnTTRegistry, entt::entity Entity)
+{
+	RecordValue(EECSReplayRecord::Patch, Type, Entity);
+}
+
+void FECSReplayRecorder::OnComponentDestroyed(entt::id_type Type, entt::registry& EnTTRegistry, entt::entity Entity)
+{
+	const FECSComponentType* ComponentType = FECSComponentTypes::Find(Type);
+	uint16 TypeIndex = GetTypeIndex(*ComponentType);
+
+	uint8 Record = static_cast<uint8>(EECSReplayRecord::Remove);
+	uint32 Id = entt::to_integral(Entity);
+	FrameWriter << Record << Id << TypeIndex;
+}
+
+void FECSReplayRecorder::RecordValue(EECSReplayRecord Record, entt::id_type Type, entt::entity Entity)
+{
+	const FECSComponentType* ComponentType = FECSComponentTypes::Find(Type);
+	uint16 TypeIndex = GetTypeIndex(*ComponentType);
+
+	// The value is written to a scratch buffer first, so its size can precede it and the player can skip unknown types
+	ValueBuffer.Reset();
+	FMemoryWriter ValueWriter(ValueBuffer);
+	ComponentType->Save(*ComponentType, Registry, Entity, ValueWriter);
+
+	uint8 RecordByte = static_cast<uint8>(Record);
+	uint32 Id = entt::to_integral(Entity);
+	uint32 Size = ValueBuffer.Num();
+	FrameWriter << RecordByte << Id << TypeIndex << Size;
+	FrameWriter.Serialize(ValueBuffer.GetData(), Size);
+}
+
+uint16 FECSReplayRecorder::GetTypeIndex(const FECSComponentType& Type)
+{
+	if (const uint16* Index = TypeIndices.Find(Type.Id))
+	{
+		return *Index;
+	}
+
+	uint16 Index = TypeIndices.Num();
+	TypeIndices.Add(Type.Id, Index);
+
+	uint8 Record = static_cast<uint8>(EECSReplayRecord::Type);
+	FString Name = Type.Name.ToString();
+	FrameWriter << Record << Index << Name;
+	return Index;
+}
+
+
+//////////////////////////////////////////////////
+//////////////////////////////////////////////////
+FECSReplayPlayer::FECSReplayPlayer(IECSRegistryInterface& Registry)
+	: Registry(Registry)
+{
+}
+
+FECSReplayPlayer::~FECSReplayPlayer()
+{
+	Close();
+}
+
+//////////////////////////////////////////////////
+bool FECSReplayPlayer::Open(const FString& FilePath, bool bInTickAutomatically)
+{
+	Close();
+	bTickAutomatically = bInTickAutomatically;
+	NumFrames = 0;
+
+	if (Registry.Player)
+	{
+		UE_LOG(LogUnrealECS, Error, TEXT("Another replay is already playing into the registry"));
+		return false;
+	}
+
+	File.Reset(IFileManager::Get().CreateFileReader(*FilePath));
+	if (!File.IsValid())
+	{
+		UE_LOG(LogUnrealECS, Error, TEXT("Could not open %s for replay"), *FilePath);
+		return false;
+	}
+	Registry.Player = this;
+
+	uint32 Magic = 0, Version = 0;
+	*File << Magic << Version;
+	if (Magic != FECSReplayRecorder::FileMagic || Version != FECSReplayRecorder::FileVersion)
+	{
+		UE_LOG(LogUnrealECS, Error, TEXT("%s is not an ECS replay or was written by another version"), *FilePath);
+		Close();
+		return false;
+	}
+	return true;
+}
+
+void FECSReplayPlayer::Close()
+{
+	// The registry is only touched while a file is open, it may already be gone when a closed player is destroyed
+	if (File.IsValid())
+	{
+		File->Close();
+		File.Reset();
+		Registry.Player = nullptr;
+	}
+	Types.Reset();
+	Entities.Reset();
+}
+
+//////////////////////////////////////////////////
+bool FECSReplayPlayer::StepFrame()
+{
+	if (!File.IsValid())
+	{
+		return false;
+	}
+
+	SCOPE_CYCLE_COUNTER(STAT_ReplayFrame);
+	entt::registry& EnTTRegistry = Registry.GetEntTTReg();
+
+	while (!File->AtEnd() && !File->IsError())
+	{
+		uint8 RecordByte = 0;
+		*File << RecordByte;
+
+		switch (static_cast<EECSReplayRecord>(RecordByte))
+		{
+		case EECSReplayRecord::Frame:
+			*File << FrameDeltaTime;
+			++NumFrames;
+			return true;
+
+		case EECSReplayRecord::Type:
+			{
+				uint16 Index = 0;
+				FString Name;
+				*File << Index << Name;
+
+				const FECSComponentType* Type = FECSComponentTypes::Find(FName(*Name));
+				if (!Type || !Type->Load)
+				{
+					UE_LOG(LogUnrealECS, Warning, TEXT("The recorded component %s is unknown and skipped"), *Name);
+					Type = nullptr;
+				}
+				Types.SetNumZeroed(FMath::Max<int32>(Types.Num(), Index + 1));
+				Types[Index] = Type;
+			}
+			break;
+
+		case EECSReplayRecord::Create:
+			{
+				uint32 Id = 0;
+				*File << Id;
+				MapEntity(Id);
+			}
+			break;
+
+		case EECSReplayRecord::Destroy:
+			{
+				uint32 Id = 0;
+				*File << Id;
+				entt::entity Entity;
+				if (Entities.RemoveAndCopyValue(Id, Entity) && EnTTRegistry.valid(Entity))
+				{
+					EnTTRegistry.destroy(Entity);
+				}
+			}
+			break;
+
+		case EECSReplayRecord::Emplace:
+		case EECSReplayRecord::Patch:
+			{
+				uint32 Id = 0, Size = 0;
+				uint16 TypeIndex = 0;
+				*File << Id << TypeIndex << Size;
+
+				ValueBuffer.SetNumUninitialized(Size);
+				File->Serialize(ValueBuffer.GetData(), Size);
+
+				if (const FECSComponentType* Type = Types.IsValidIndex(TypeIndex) ? Types[TypeIndex] : nullptr)
+				{
+					FMemoryReader ValueReader(ValueBuffer);
+					Type->Load(*Type, Registry, MapEntity(Id), ValueReader);
+				}
+			}
+			break;
+
+		case EECSReplayRecord::Remove:
+			{
+				uint32 Id = 0;
+				uint16 TypeIndex = 0;
+				*File << Id << TypeIndex;
+
+				const FECSComponentType* Type = Types.IsValidIndex(TypeIndex) ? Types[TypeIndex] : nullptr;
+				const entt::entity* Entity = Entities.Find(Id);
+				if (Type && Entity)
+				{
+					Type->Remove(EnTTRegistry, *Entity);
+				}
+			}
+			break;
+
+		default:
+			UE_LOG(LogUnrealECS, Error, TEXT("The replay is corrupt, unknown record %d"), RecordByte);
+			File->SetError();
+			break;
+		}
+	}
+
+	// An unfinished frame at the end of the file isn't applied completely, but there's nothing to undo it with
+	Close();
+	OnFinished.Broadcast();
+	return false;
+}
+
+entt::entity FECSReplayPlayer::MapEntity(uint32 Recorded)
+{
+	if (const entt::entity* Entity = Entities.Find(Recorded))
+	{
+		return *Entity;
+	}
+	return Entities.Add(Recorded, Registry.GetEntTTReg().create());
+}
+
+//////////////////////////////////////////////////
+void FECSReplayPlayer::Tick(float DeltaTime)
+{
+	StepFrame();
+}
+
+bool FECSReplayPlayer::IsTickable() const
+{
+	return bTickAutomatically && File.IsValid();
+}
+
+TStatId FECSReplayPlayer::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(FECSReplayPlayer, STATGROUP_ECS);
+}
+
+
+//////////////////////////////////////////////////
+//////////////////////////////////////////////////
+static TUniquePtr<FECSReplayRecorder> GReplayRecorder;
+static TUniquePtr<FECSReplayPlayer> GReplayPlayer;
+
+static FAutoConsoleCommand StartReplayRecordingCommand(
+	TEXT("ecs.Replay.Record"),
+	TEXT("Records the mutations of the game instance registry. Optional argument: File path"),
+	FConsoleCommandWithArgsDelegate::CreateLambda([](const TArray<FString>& Args)
+	{
+		if (UECSRegistry::HasRegistry())
+		{
+			const FString FilePath = Args.Num() > 0
+				? Args[0]
+				: FPaths::ProfilingDir() / FString::Printf(TEXT("ECSReplay-%s.ecsreplay"), *FDateTime::Now().ToString());
+			GReplayRecorder.Reset();
+			GReplayRecorder = MakeUnique<FECSReplayRecorder>(UECSRegistry::GetRegistry());
+			GReplayRecorder->Start(FilePath);
+		}
+	}));
+
+static FAutoConsoleCommand StopReplayCommand(
+	TEXT("ecs.Replay.Stop"),
+	TEXT("Stops recording and replaying the game instance registry"),
+	FConsoleCommandDelegate::CreateLambda([]()
+	{
+		GReplayRecorder.Reset();
+		GReplayPlayer.Reset();
+	}));
+
+static FAutoConsoleCommand PlayReplayCommand(
+	TEXT("ecs.Replay.Play"),
+	TEXT("Replays a recording into the game instance registry, one recorded frame per tick. Argument: File path"),
+	FConsoleCommandWithArgsDelegate::CreateLambda([](const TArray<FString>& Args)
+	{
+		if (UECSRegistry::HasRegistry() && Args.Num() > 0)
+		{
+			GReplayPlayer = MakeUnique<FECSReplayPlayer>(UECSRegistry::GetRegistry());
+			GReplayPlayer->Open(Args[0]);
+		}
+	}));
@@ -0,0 +1,322 @@
+
+#include "ECSStats.h"
+#include "ECSRegistry.h"
+#include "UEEnTTSystem.h"
+#include "UnrealEngineECS.h"
+#include "Engine/Engine.h"
+#include "HAL/FileManager.h"
+#include "HAL/IConsoleManager.h"
+#include "Misc/Paths.h"
+
+DECLARE_DWORD_COUNTER_STAT(TEXT("Entities alive"), STAT_ECSEntitiesAlive, STATGROUP_ECS);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Tracked pools: Components"), STAT_ECSTrackedComponents, STATGROUP_ECS);
+DECLARE_FLOAT_COUNTER_STAT(TEXT("Tracked pools: Created per second"), STAT_ECSCreatedPerSecond, STATGROUP_ECS);
+DECLARE_FLOAT_COUNTER_STAT(TEXT("Tracked pools: Destroyed per second"), STAT_ECSDestroyedPerSecond, STATGROUP_ECS);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Backlog size"), STAT_ECSBacklog, STATGROUP_ECS);
+
+static TAutoConsoleVariable<int32> CVarStatsOverlay(
+	TEXT("ecs.Stats.Overlay"),
+	0,
+	TEXT("Shows the ECS pools on screen, sorted by churn, and the backlogs and systems. The value is the number of lines to show per section"),
+	ECVF_Default);
+
+
+//////////////////////////////////////////////////
+FECSStats::~FECSStats()
+{
+	StopCsv();
+	for (const TUniquePtr<FPool>& Pool : Pools)
+	{
+		Pool->Disconnect();
+	}
+}
+
+//////////////////////////////////////////////////
+void FECSStats::TrackBacklog(const void* Owner, const FString& Name, TFunction<int32()>&& GetSize)
+{
+	Backlogs.Add({ Owner, Name, MoveTemp(GetSize) });
+}
+
+void FECSStats::UntrackBacklog(const void* Owner)
+{
+	Backlogs.RemoveAll([Owner](const FBacklog& Backlog) { return Backlog.Owner == Owner; });
+}
+
+//////////////////////////////////////////////////
+void FECSStats::RecordSystemRun(const UECSSystem* System, int32 NumEntities, uint64 Cycles)
+{
+	FSystem& Stats = Systems.FindOrAdd(System);
+	if (Stats.Stats.Name.IsEmpty())
+	{
+		Stats.Stats.Name = System->GetClass()->GetName();
+	}
+	Stats.NumEntities += NumEntities;
+	Stats.NumRuns++;
+	Stats.Cycles += Cycles;
+}
+
+void FECSStats::RemoveSystem(const UECSSystem* System)
+{
+	Systems.Remove(System);
+}
+
+//////////////////////////////////////////////////
+void FECSStats::Tick(float DeltaTime, const entt::registry& Registry)
+{
+	NumEntitiesAlive = static_cast<int32>(Registry.alive());
+	TimeSinceSample += DeltaTime;
+	TotalTime += DeltaTime;
+
+	if (TimeSinceSample >= 1.f)
+	{
+		for (const TUniquePtr<FPool>& Pool : Pools)
+		{
+			Pool->Stats.Size = Pool->GetSize();
+			Pool->Stats.CreatedPerSecond = Pool->NumCreated / TimeSinceSample;
+			Pool->Stats.DestroyedPerSecond = Pool->NumDestroyed / TimeSinceSample;
+			Pool->NumCreated = 0;
+			Pool->NumDestroyed = 0;
+		}
+
+		for (TPair<const UECSSystem*, FSystem>& System : Systems)
+		{
+			FSystem& Stats = System.Value;
+			Stats.Stats.EntitiesPerSecond = Stats.NumEntities / TimeSinceSample;
+			Stats.Stats.AverageRunTimeMs = Stats.NumRuns > 0 ? FPlatformTime::ToMilliseconds64(Stats.Cycles) / Stats.NumRuns : 0.f;
+			Stats.NumEntities = 0;
+			Stats.NumRuns = 0;
+			Stats.Cycles = 0;
+		}
+
+		TimeSinceSample = 0.f;
+		WriteCsv();
+	}
+
+	int32 NumComponents = 0;
+	float CreatedPerSecond = 0.f;
+	float DestroyedPerSecond = 0.f;
+	for (const TUniquePtr<FPool>& Pool : Pools)
+	{
+		NumComponents += Pool->Stats.Size;
+		CreatedPerSecond += Pool->Stats.CreatedPerSecond;
+		DestroyedPerSecond += Pool->Stats.DestroyedPerSecond;
+	}
+
+	int32 BacklogSize = 0;
+	for (const FBacklog& Backlog : Backlogs)
+	{
+		BacklogSize += Backlog.GetSize();
+	}
+	
+	SET_DWORD_STAT(STAT_ECSEntitiesAlive, NumEntitiesAlive);
+	SET_DWORD_STAT(STAT_ECSTrackedComponents, NumComponents);
+	SET_FLOAT_STAT(STAT_ECSCreatedPerSecond, CreatedPerSecond);
+	SET_FLOAT_STAT(STAT_ECSDestroyedPerSecond, DestroyedPerSecond);
+	SET_DWORD_STAT(STAT_ECSBacklog, BacklogSize);
+
+	DrawOverlay();
+}
+
+//////////////////////////////////////////////////
+TArray<FECSPoolStats> FECSStats::GetPoolStats() const
+{
+	TArray<FECSPoolStats> Stats;
+	for (const TUniquePtr<FPool>& Pool : Pools)
+	{
+		Stats.Add(Pool->Stats);
+	}
+	Stats.Sort([](const FECSPoolStats& A, const FECSPoolStats& B) { return A.GetChurn() > B.GetChurn(); });
+	return Stats;
+}
+
+FString FECSStats::FindPoolName(entt::id_type Id) const
+{
+	const TUniquePtr<FPool>* Pool = Pools.FindByPredicate([Id](const TUniquePtr<FPool>& Tracked) { return Tracked->Id == Id; });
+	return Pool ? (*Pool)->Stats.Name : FString();
+}
+
+TArray<FECSBacklogStats> FECSStats::GetBacklogStats() const
+{
+	TArray<FECSBacklogStats> Stats;
+	for (const FBacklog& Backlog : Backlogs)
+	{
+		Stats.Add({ Backlog.Name, Backlog.GetSize() });
+	}
+	return Stats;
+}
+
+TArray<FECSSystemStats> FECSStats::GetSystemStats() const
+{
+	TArray<FECSSystemStats> Stats;
+	for (const TPair<const UECSSystem*, FSystem>& System : Systems)
+	{
+		Stats.Add(System.Value.Stats);
+	}
+	return Stats;
+}
+
+//////////////////////////////////////////////////
+void FECSStats::Dump() const
+{
+	UE_LOG(LogUnrealECS, Display, TEXT("ECS stats: %d entities alive"), NumEntitiesAlive);
+	
+	for (const FECSPoolStats& Pool : GetPoolStats())
+	{
+		UE_LOG(LogUnrealECS, Display, TEXT("  Pool %-48s %8d components, %8.1f created/s, %8.1f destroyed/s"),
+			   *Pool.Name, Pool.Size, Pool.CreatedPerSecond, Pool.DestroyedPerSecond);
+	}
+	
+	for (const FECSBacklogStats& Backlog : GetBacklogStats())
+	{
+		UE_LOG(LogUnrealECS, Display, TEXT("  Backlog %-45s %8d entities"), *Backlog.Name, Backlog.Size);
+	}
+
+	for (const FECSSystemStats& System : GetSystemStats())
+	{
+		UE_LOG(LogUnrealECS, Display, TEXT("  System %-46s %10.1f entities/s, %6.3f ms/run"),
+			   *System.Name, System.EntitiesPerSecond, System.AverageRunTimeMs);
+	}
+}
+
+//////////////////////////////////////////////////
+void FECSStats::DrawOverlay() const
+{
+	const int32 NumLines = CVarStatsOverlay.GetValueOnGameThread();
+	if (NumLines <= 0 || !GEngine)
+	{
+		return;
+	}
+
+	TArray<TPair<FColor, FString>> Lines;
+	Lines.Emplace(FColor::White, FString::Printf(TEXT("ECS: %d entities"), NumEntitiesAlive));
+
+	const TArray<FECSPoolStats> Pools = GetPoolStats();
+	const float MaxChurn = Pools.Num() > 0 ? FMath::Max(Pools[0].GetChurn(), 1.f) : 1.f;
+	for (int32 Index = 0; Index < FMath::Min(NumLines, Pools.Num()); ++Index)
+	{
+		const FECSPoolStats& Pool = Pools[Index];
+		const FColor Color = FLinearColor::LerpUsingHSV(FLinearColor::Green, FLinearColor::Red, Pool.GetChurn() / MaxChurn).ToFColor(true);
+		Lines.Emplace(Color, FString::Printf(TEXT("%s: %d (+%.0f/s -%.0f/s)"), *Pool.Name, Pool.Size,
+											 Pool.CreatedPerSecond, Pool.DestroyedPerSecond));
+	}
+
+	// Largest backlogs first, entities that wait are shown in yellow
+	TArray<FECSBacklogStats> Backlogs = GetBacklogStats();
+	Backlogs.Sort([](const FECSBacklogStats& A, const FECSBacklogStats& B) { return A.Size > B.Size; });
+	for (int32 Index = 0; Index < FMath::Min(NumLines, Backlogs.Num()); ++Index)
+	{
+		const FECSBacklogStats& Backlog = Backlogs[Index];
+		Lines.Emplace(Backlog.Size > 0 ? FColor::Yellow : FColor::White,
+					  FString::Printf(TEXT("Backlog %s: %d entities"), *Backlog.Name, Backlog.Size));
+	}
+
+	// Slowest systems first
+	TArray<FECSSystemStats> Systems = GetSystemStats();
+	Systems.Sort([](const FECSSystemStats& A, const FECSSystemStats& B) { return A.AverageRunTimeMs > B.AverageRunTimeMs; });
+	for (int32 Index = 0; Index < FMath::Min(NumLines, Systems.Num()); ++Index)
+	{
+		const FECSSystemStats& System = Systems[Index];
+		Lines.Emplace(FColor::Cyan, FString::Printf(TEXT("System %s: %.0f entities/s, %.3f ms/run"), *System.Name,
+													System.EntitiesPerSecond, System.AverageRunTimeMs));
+	}
+
+	// Messages with a key replace the message of the last frame. Added in reverse, because new messages are shown on top
+	const uint64 KeyBase = reinterpret_cast<uint64>(this);
+	for (int32 Index = Lines.Num() - 1; Index >= 0; --Index)
+	{
+		GEngine->AddOnScreenDebugMessage(KeyBase + Index, 0.f, Lines[Index].Key, Lines[Index].Value);
+	}
+}
+
+//////////////////////////////////////////////////
+bool FECSStats::StartCsv(const FString& FilePath)
+{
+	StopCsv();
+	CsvFile.Reset(IFileManager::Get().CreateFileWriter(*FilePath));
+	if (!CsvFile.IsValid())
+	{
+		UE_LOG(LogUnrealECS, Error, TEXT("Could not create %s"), *FilePath);
+		return false;
+	}
+	
+	ANSICHAR Header[] = "Time,Kind,Name,Size,CreatedPerSecond,DestroyedPerSecond,EntitiesPerSecond,RunTimeMs\n";
+	CsvFile->Serialize(Header, sizeof(Header) - 1);
+	UE_LOG(LogUnrealECS, Display, TEXT("Writing ECS stats to %s"), *FilePath);
+	return true;
+}
+
+void FECSStats::StopCsv()
+{
+	if (CsvFile.IsValid())
+	{
+		CsvFile->Close();
+		CsvFile.Reset();
+	}
+}
+
+void FECSStats::WriteCsv()
+{
+	if (!CsvFile.IsValid())
+	{
+		return;
+	}
+
+	FString Rows = FString::Printf(TEXT("%.1f,Entities,Alive,%d,,,,\n"), TotalTime, NumEntitiesAlive);
+	for (const TUniquePtr<FPool>& Pool : Pools)
+	{
+		Rows += FString::Printf(TEXT("%.1f,Pool,%s,%d,%.1f,%.1f,,\n"), TotalTime, *Pool->Stats.Name, Pool->Stats.Size,
+								Pool->Stats.CreatedPerSecond, Pool->Stats.DestroyedPerSecond);
+	}
+	for (const FBacklog& Backlog : Backlogs)
+	{
+		Rows += FString::Printf(TEXT("%.1f,Backlog,%s,%d,,,,\n"), TotalTime, *Backlog.Name, Backlog.GetSize());
+	}
+	for (const TPair<const UECSSystem*, FSystem>& System : Systems)
+	{
+		Rows += FString::Printf(TEXT("%.1f,System,%s,,,,%.1f,%.3f\n"), TotalTime, *System.Value.Stats.Name,
+								System.Value.Stats.EntitiesPerSecond, System.Value.Stats.AverageRunTimeMs);
+	}
+
+	const FTCHARToUTF8 Converted(*Rows);
+	CsvFile->Serialize(const_cast<ANSICHAR*>(Converted.Get()), Converted.Length());
+	CsvFile->Flush();
+}
+
+
+//////////////////////////////////////////////////
+//////////////////////////////////////////////////
+static FAutoConsoleCommand DumpStatsCommand(
+	TEXT("ecs.Stats"),
+	TEXT("Logs the pool sizes, churn, backlogs and system throughput of the game instance registry"),
+	FConsoleCommandDelegate::CreateLambda([]()
+	{
+		if (UECSRegistry::HasRegistry())
+		{
+			UECSRegistry::GetRegistry().GetStats().Dump();
+		}
+	}));
+
+static FAutoConsoleCommand StartCsvCommand(
+	TEXT("ecs.Stats.CsvStart"),
+	TEXT("Writes the ECS stats of the game instance registry to a CSV file every second. Optional argument: File path"),
+	FConsoleCommandWithArgsDelegate::CreateLambda([](const TArray<FString>& Args)
+	{
+		if (UECSRegistry::HasRegistry())
+		{
+			const FString FilePath = Args.Num() > 0
+				? Args[0]
+				: FPaths::ProfilingDir() / FString::Printf(TEXT("ECSStats-%s.csv"), *FDateTime::Now().ToString());
+			UECSRegistry::GetRegistry().GetStats().StartCsv(FilePath);
+		}
+	}));
+
+static FAutoConsoleCommand StopCsvCommand(
+	TEXT("ecs.Stats.CsvStop"),
+	TEXT("Stops writing the ECS stats to a CSV file"),
+	FConsoleCommandDelegate::CreateLambda([]()
+	{
+		if (UECSRegistry::HasRegistry())
+		{
+			UECSRegistry::GetRegistry().GetStats().StopCsv();
+		}
+	}));
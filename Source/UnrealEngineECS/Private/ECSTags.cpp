@@ -0,0 +1,22 @@
+
+#include "ECSTags.h"
+#include "UnrealEngineECS.h"
+
+
+//////////////////////////////////////////////////
+uint64 FECSTagSignature::GetBit(entt::id_type TagTypeId)
+{
+	static FCriticalSection Mutex;
+	static TMap<entt::id_type, uint64> Bits;
+
+	FScopeLock Lock(&Mutex);
+	if (const uint64* Bit = Bits.Find(TagTypeId))
+	{
+		return *Bit;
+	}
+
+	checkf(Bits.Num() < 64, TEXT("Only 64 different tag types are supported"));
+	const uint64 NewBit = uint64(1) << Bits.Num();
+	Bits.Add(TagTypeId, NewBit);
+	return NewBit;
+}
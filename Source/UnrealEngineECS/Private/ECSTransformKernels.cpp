@@ -0,0 +1,108 @@
+
+#include "ECSTransformKernels.h"
+
+static_assert(sizeof(FECSPosition) == 3 * sizeof(float) && sizeof(FECSVelocity) == 3 * sizeof(float),
+			  "The position kernels treat the components as packed float arrays");
+static_assert(alignof(FECSRotation) == 16, "The rotation kernels use aligned loads");
+
+
+//////////////////////////////////////////////////
+void ECS::Kernels::IntegrateVelocity(FECSPosition* Positions, const FECSVelocity* Velocities, int32 Count, float DeltaTime)
+{
+	// Both arrays are packed floats, so we can process four floats at once, regardless of the vector boundaries
+	float* Position = &Positions[0].Value.X;
+	const float* Velocity = &Velocities[0].Value.X;
+	const int32 NumFloats = Count * 3;
+	const VectorRegister Delta = VectorSetFloat1(DeltaTime);
+
+	int32 Index = 0;
+	for (; Index + 4 <= NumFloats; Index += 4)
+	{
+		VectorStore(VectorMultiplyAdd(VectorLoad(Velocity + Index), Delta, VectorLoad(Position + Index)), Position + Index);
+	}
+	
+	for (; Index < NumFloats; ++Index)
+	{
+		Position[Index] += Velocity[Index] * DeltaTime;
+	}
+}
+
+void ECS::Kernels::NormalizeRotations(FECSRotation* Rotations, int32 Count)
+{
+	for (int32 Index = 0; Index < Count; ++Index)
+	{
+		const VectorRegister Rotation = VectorLoadAligned(&Rotations[Index].Value);
+		VectorStoreAligned(VectorNormalizeQuaternion(Rotation), &Rotations[Index].Value);
+	}
+}
+
+void ECS::Kernels::ComposeRotations(FECSRotation* Rotations, const FECSRotation* Deltas, int32 Count)
+{
+	for (int32 Index = 0; Index < Count; ++Index)
+	{
+		const VectorRegister Rotation = VectorLoadAligned(&Rotations[Index].Value);
+		const VectorRegister Delta = VectorLoadAligned(&Deltas[Index].Value);
+		VectorStoreAligned(VectorQuaternionMultiply2(Delta, Rotation), &Rotations[Index].Value);
+	}
+}
+
+//////////////////////////////////////////////////
+void ECS::Kernels::IntegrateVelocity(IECSRegistryInterface& Registry, float DeltaTime)
+{
+	// Disabled entities only split the packed arrays into runs, each run still goes through the vectorized kernel
+	auto Group = Registry.Group<FECSPosition, FECSVelocity>();
+	FECSPosition* Positions = Group.raw<FECSPosition>();
+	const FECSVelocity* Velocities = Group.raw<FECSVelocity>();
+	Registry.EachEnabledRange(Group, [Positions, Velocities, DeltaTime](int32 Begin, int32 End)
+	{
+		IntegrateVelocity(Positions + Begin, Velocities + Begin, End - Begin, DeltaTime);
+	});
+}
+
+void ECS::Kernels::NormalizeRotations(IECSRegistryInterface& Registry)
+{
+	auto View = Registry.View<FECSRotation>();
+	FECSRotation* Rotations = View.raw();
+	Registry.EachEnabledRange(View, [Rotations](int32 Begin, int32 End)
+	{
+		NormalizeRotations(Rotations + Begin, End - Begin);
+	});
+}
+
+void ECS::Kernels::PackTransforms(IECSRegistryInterface& Registry)
+{
+	Registry.EachEnabled(Registry.View<const FECSPosition, FTransform>(),
+		[](entt::entity Entity, const FECSPosition& Position, FTransform& Transform)
+		{
+			Transform.SetTranslation(Position.Value);
+		});
+
+	Registry.EachEnabled(Registry.View<const FECSRotation, FTransform>(),
+		[](entt::entity Entity, const FECSRotation& Rotation, FTransform& Transform)
+		{
+			Transform.SetRotation(Rotation.Value);
+		});
+
+	Registry.EachEnabled(Registry.View<const FECSScale, FTransform>(),
+		[](entt::entity Entity, const FECSScale& Scale, FTransform& Transform)
+		{
+			Transform.SetScale3D(Scale.Value);
+		});
+}
+
+void ECS::Kernels::UnpackTransform(entt::registry& Registry, entt::entity Entity, const FTransform& Transform)
+{
+	auto [Position, Rotation, Scale] = Registry.try_get<FECSPosition, FECSRotation, FECSScale>(Entity);
+	if (Position)
+	{
+		Position->Value = Transform.GetTranslation();
+	}
+	if (Rotation)
+	{
+		Rotation->Value = Transform.GetRotation();
+	}
+	if (Scale)
+	{
+		Scale->Value = Transform.GetScale3D();
+	}
+}
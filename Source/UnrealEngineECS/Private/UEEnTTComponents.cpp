@@ -20,11 +20,12 @@ void UECS_BridgeComponent::RegisterComponentWithECS()
 
 	EntityHandle.AddComponent<FActorPtrComponent>(GetOwner());
 
-	// Register all other ECS components from our owner
+	// Register all other ECS components from our owner. When registered in a batch, they already share our entity and are
+	// registered by the batch
 	TInlineComponentArray<UECSComponentWrapper*> WrapperComponents (GetOwner());
 	for (UECSComponentWrapper* Component : WrapperComponents)
 	{
-		if (Component != this)
+		if (Component != this && Component->EntityHandle != EntityHandle)
 		{
 			Component->EntityHandle = EntityHandle;
 			Component->RegisterComponentWithECS();			
@@ -32,6 +33,11 @@ void UECS_BridgeComponent::RegisterComponentWithECS()
 	}
 }
 
+void UECS_BridgeComponent::ReserveECSComponents(IECSRegistryInterface& Registry, TArrayView<UECSComponentWrapper* const> Instances) const
+{
+	Registry.Reserve<FActorPtrComponent>(Registry.Size<FActorPtrComponent>() + Instances.Num());
+}
+
 //////////////////////////////////////////////////
 //////////////////////////////////////////////////
 void UECS_SyncTransformComponent::RegisterComponentWithECS()
@@ -41,49 +47,39 @@ void UECS_SyncTransformComponent::RegisterComponentWithECS()
 	UpdateECSComponent();
 }
 
+void UECS_SyncTransformComponent::ReserveECSComponents(IECSRegistryInterface& Registry, TArrayView<UECSComponentWrapper* const> Instances) const
+{
+	// Every instance adds all of them regardless of its sync type, the sync type only enables or disables them
+	const int32 Count = Instances.Num();
+	Registry.Reserve<FTransform>(Registry.Size<FTransform>() + Count);
+	Registry.Reserve<FSyncTransformToECS>(Registry.Size<FSyncTransformToECS>() + Count);
+	Registry.Reserve<TECSShared<FSyncTransformToActor>>(Registry.Size<TECSShared<FSyncTransformToActor>>() + Count);
+}
+
 void UECS_SyncTransformComponent::UpdateECSComponent()
 {
 	USceneComponent* OwnerRoot = GetOwner()->GetRootComponent();
-	
-	if (SyncType == ESyncType::Disabled)
-	{
-		OwnerRoot->TransformUpdated.Remove(TransformChangedHandle);
-		TransformChangedHandle.Reset();
-
-		EntityHandle.RemoveComponentChecked<FSyncTransformToECS>();
-		EntityHandle.RemoveComponentChecked<FSyncTransformToActor>();
-		return;
-	}
+	const bool bSyncToECS = SyncType == ESyncType::Actor_To_ECS || SyncType == ESyncType::BothWays;
+	const bool bSyncToActor = SyncType == ESyncType::ECS_To_Actor || SyncType == ESyncType::BothWays;
 
-	if (SyncType == ESyncType::Actor_To_ECS)
+	// Both sync components stay on the entity and are only enabled or disabled, so switching the sync type doesn't change any pool
+	if (!EntityHandle.HasComponent<FSyncTransformToECS>())
 	{
-		EntityHandle.RemoveComponentChecked<FSyncTransformToActor>();		
-		EntityHandle.AddOrReplaceComponent<FSyncTransformToECS>();
-
-		if (!TransformChangedHandle.IsValid())
-		{
-			TransformChangedHandle = OwnerRoot->TransformUpdated.AddUObject(this, &UECS_SyncTransformComponent::OnRootComponentTransformChanged);
-		}
+		EntityHandle.AddComponent<FSyncTransformToECS>();
 	}
-	else if (SyncType == ESyncType::ECS_To_Actor)
+	EntityHandle.SetShared<FSyncTransformToActor>(DefaultValues);
+	
+	EntityHandle.SetComponentEnabled<FSyncTransformToECS>(bSyncToECS);
+	EntityHandle.SetComponentEnabled<TECSShared<FSyncTransformToActor>>(bSyncToActor);
+
+	if (bSyncToECS && !TransformChangedHandle.IsValid())
 	{
-		if (EntityHandle.RemoveComponentChecked<FSyncTransformToECS>())
-		{
-			OwnerRoot->TransformUpdated.Remove(TransformChangedHandle);
-			TransformChangedHandle.Reset();
-		}
-		
-		EntityHandle.AddOrReplaceComponent<FSyncTransformToActor>(DefaultValues);
+		TransformChangedHandle = OwnerRoot->TransformUpdated.AddUObject(this, &UECS_SyncTransformComponent::OnRootComponentTransformChanged);
 	}
-	else if (SyncType == ESyncType::BothWays)
+	else if (!bSyncToECS && TransformChangedHandle.IsValid())
 	{
-		EntityHandle.AddOrReplaceComponent<FSyncTransformToECS>();
-		EntityHandle.AddOrReplaceComponent<FSyncTransformToActor>(DefaultValues);
-
-		if (!TransformChangedHandle.IsValid())
-		{
-			TransformChangedHandle = OwnerRoot->TransformUpdated.AddUObject(this, &UECS_SyncTransformComponent::OnRootComponentTransformChanged);
-		}
+		OwnerRoot->TransformUpdated.Remove(TransformChangedHandle);
+		TransformChangedHandle.Reset();
 	}
 }
 
@@ -91,5 +87,5 @@ void UECS_SyncTransformComponent::UpdateECSComponent()
 void UECS_SyncTransformComponent::OnRootComponentTransformChanged(USceneComponent* UpdatedComponent,
 																  EUpdateTransformFlags UpdateTransformFlags, ETeleportType Teleport)
 {
-	EntityHandle.GetComponent<FSyncTransformToECS>().bSyncTransform = true;
+	GetEntityHandle().AddTag<FActorTransformChanged>();
 }
@@ -2,6 +2,24 @@
 #include "UEEnTTEntity.h"
 
 const FEntity FEntity::NullEntity = FEntity();
+const FEntityId FEntityId::NullId = FEntityId();
+
+
+//////////////////////////////////////////////////
+FEntityId::FEntityId(const FEntity& Entity)
+{
+	EntityHandle = Entity.EntityHandle;
+}
+
+FEntity FEntityId::Resolve(IECSRegistryInterface& Registry) const
+{
+	return FEntity(EntityHandle, Registry);
+}
+
+bool FEntityId::IsValid(const IECSRegistryInterface& Registry) const
+{
+	return Registry.IsValid(*this);
+}
 
 
 //////////////////////////////////////////////////
@@ -11,20 +29,41 @@ FEntity::FEntity(entt::entity Handle, IECSRegistryInterface& Registry)
 	this->OwningRegistry = &Registry;
 }
 
+FEntity::FEntity(FEntityId Id, IECSRegistryInterface& Registry)
+{
+	this->EntityHandle = Id.GetHandle();
+	this->OwningRegistry = &Registry;
+}
+
 //////////////////////////////////////////////////
+bool FEntity::IsValid() const
+{
+	return OwningRegistry && OwningRegistry->Registry.valid(EntityHandle);
+}
+
+void FEntity::SetEnabled(bool bEnabled)
+{
+	OwningRegistry->SetEnabled(EntityHandle, bEnabled);
+}
+
+bool FEntity::IsEnabled() const
+{
+	return OwningRegistry->IsEnabled(EntityHandle);
+}
+
 FEntity::operator bool() const
 {
-	return EntityHandle != entt::null;
+	return IsValid();
 }
 
 bool FEntity::operator==(const FEntity& Other) const
 {
-	return Other.EntityHandle == EntityHandle;
+	return Other.EntityHandle == EntityHandle && Other.OwningRegistry == OwningRegistry;
 }
 
 bool FEntity::operator!=(const FEntity& Other) const
 {
-	return Other.EntityHandle != EntityHandle;
+	return !(*this == Other);
 }
 
 FEntity& FEntity::operator=(const entt::entity& OtherHandle)
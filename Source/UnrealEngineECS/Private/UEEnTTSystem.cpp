@@ -5,6 +5,8 @@
 #include "GameFramework/Actor.h"
 
 #include "UEEnTTComponents.h"
+#include "ECSRegistry.h"
+#include "ECSAccessTracker.h"
 #include "Engine/World.h"
 
 
@@ -14,14 +16,38 @@ void FECSSystemTickFunction::ExecuteTick(float DeltaTime, ELevelTick TickType, E
 {
 	if (Target != nullptr)
 	{
-		Target->RunSystem(DeltaTime, CurrentThread);
+		Target->PendingTasks.Reset();
+		Target->NumProcessedEntities = 0;
+		const uint64 StartCycles = FPlatformTime::Cycles64();
+		{
+			FECSAccessScope AccessScope(Target);
+			Target->RunSystem(DeltaTime, CurrentThread);
+		}
+
+		if (Target->Registry)
+		{
+			Target->Registry->GetStats().RecordSystemRun(Target, Target->NumProcessedEntities, FPlatformTime::Cycles64() - StartCycles);
+		}
+
+		// Hold the completion of this tick until all async work that was launched by the system is done
+		for (const FGraphEventRef& Task : Target->PendingTasks)
+		{
+			MyCompletionGraphEvent->DontCompleteUntil(Task);
+		}
 	}
 }
 
 //////////////////////////////////////////////////
 FString FECSSystemTickFunction::DiagnosticMessage()
 {
-	return Target->GetFullName() + TEXT("[ECS TickSystem]");
+	FString Message = Target->GetFullName() + TEXT("[ECS TickSystem]");
+#if ECS_WITH_ACCESS_TRACKING
+	for (const FString& Conflict : FECSAccessTracker::GetConflicts(Target))
+	{
+		Message += TEXT("\n\tAccess conflict: ") + Conflict;
+	}
+#endif
+	return Message;
 }
 
 FName FECSSystemTickFunction::DiagnosticContext(bool bDetailed)
@@ -44,6 +70,7 @@ FName FECSSystemTickFunction::DiagnosticContext(bool bDetailed)
 void UECSSystem::Initialize(FSubsystemCollectionBase& Collection)
 {
 	Super::Initialize(Collection);
+	Registry = Cast<UECSRegistry>(Collection.InitializeDependency(UECSRegistry::StaticClass()));
 	if (UWorld* World = GetWorld())
 	{
 		RegisterTickFunction(World);
@@ -54,7 +81,20 @@ void UECSSystem::Deinitialize()
 {
 	Super::Deinitialize();	
 	TickFunction.UnRegisterTickFunction();
+	if (Registry)
+	{
+		Registry->GetStats().RemoveSystem(this);
+	}
 	TickFunction.Target = nullptr;
+
+	// Don't let async work outlive the system
+	FTaskGraphInterface::Get().WaitUntilTasksComplete(PendingTasks);
+	PendingTasks.Reset();
+
+#if ECS_WITH_ACCESS_TRACKING
+	// Another system may be allocated at the same address later on
+	FECSAccessTracker::RemoveSystem(this);
+#endif
 }
 
 //////////////////////////////////////////////////
@@ -64,3 +104,24 @@ void UECSSystem::RegisterTickFunction(UWorld* World)
 	TickFunction.RegisterTickFunction(Level);
 	TickFunction.Target = this;
 }
+
+void UECSSystem::AddSystemPrerequisite(UECSSystem& Other)
+{
+	TickFunction.AddPrerequisite(&Other, Other.TickFunction);
+}
+
+//////////////////////////////////////////////////
+FGraphEventRef UECSSystem::LaunchTask(TUniqueFunction<void()>&& Work, const FGraphEventArray* Prerequisites,
+									  ENamedThreads::Type Thread) const
+{
+	// The task counts as part of this system for the access tracking
+	TUniqueFunction<void()> SystemWork = [this, Work = MoveTemp(Work)]()
+	{
+		FECSAccessScope AccessScope(this);
+		Work();
+	};
+	
+	FGraphEventRef Task = FFunctionGraphTask::CreateAndDispatchWhenReady(MoveTemp(SystemWork), TStatId(), Prerequisites, Thread);
+	PendingTasks.Add(Task);
+	return Task;
+}
@@ -1,6 +1,9 @@
 // Copyright Epic Games, Inc. All Rights Reserved.
 
 #include "UnrealEngineECS.h"
+#include "ECSComponentTypes.h"
+#include "UEEnTTComponents.h"
+#include "ECSCollision.h"
 
 DEFINE_LOG_CATEGORY(LogUnrealECS);
 
@@ -10,12 +13,30 @@ DEFINE_LOG_CATEGORY(LogUnrealECS);
 void FUnrealEngineECSModule::StartupModule()
 {
 	// This code will execute after your module is loaded into memory; the exact timing is specified in the .uplugin file per-module
+
+	// Core components, so they can be imported from data files
+	FECSComponentTypes::Register<FTransform>(TEXT("Transform"), TBaseStructure<FTransform>::Get());
+	FECSComponentTypes::RegisterShared<FSyncTransformToActor>(TEXT("SyncTransformToActor"), FSyncTransformToActor::StaticStruct());
+
+	// Collision components. Without reflection data, so they can be recorded but not imported
+	FECSComponentTypes::Register<FECSSphereShape>(TEXT("SphereShape"));
+	FECSComponentTypes::Register<FECSBoxShape>(TEXT("BoxShape"));
+	FECSComponentTypes::Register<FECSCollisionFilter>(TEXT("CollisionFilter"));
+
+	// Split transform, sync and tag state. Without reflection data, so they can be recorded and migrated but not imported
+	FECSComponentTypes::Register<FECSPosition>(TEXT("Position"));
+	FECSComponentTypes::Register<FECSRotation>(TEXT("Rotation"));
+	FECSComponentTypes::Register<FECSScale>(TEXT("Scale"));
+	FECSComponentTypes::Register<FECSVelocity>(TEXT("Velocity"));
+	FECSComponentTypes::Register<FSyncTransformToECS>(TEXT("SyncTransformToECS"));
+	FECSComponentTypes::Register<FECSTagSignature>(TEXT("TagSignature"));
 }
 
 void FUnrealEngineECSModule::ShutdownModule()
 {
 	// This function may be called during shutdown to clean up your module.  For modules that support dynamic reloading,
 	// we call this function before unloading the module.
+	FECSComponentTypes::Reset();
 }
 
 #undef LOCTEXT_NAMESPACE
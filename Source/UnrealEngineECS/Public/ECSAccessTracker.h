@@ -0,0 +1,107 @@
+// Copyright @Paul Larrass 2020
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "ECSIncludes.h"
+
+/**
+ * Compiles the access tracking in. Even when compiled in, it has to be enabled at runtime with ecs.TrackAccess.
+ * Defaults to DO_GUARD_SLOW like ECS_CHECKED_ACCESS, so only Debug builds pay for the check in every view, group and accessor.
+ * Add "ECS_WITH_ACCESS_TRACKING=1" to your PublicDefinitions to track the accesses in Development builds.
+ */
+#ifndef ECS_WITH_ACCESS_TRACKING
+	#define ECS_WITH_ACCESS_TRACKING DO_GUARD_SLOW
+#endif
+
+#if ECS_WITH_ACCESS_TRACKING
+	/** Records an access to the pools of the given components. Const components are read, all others written */
+	#define ECS_RECORD_ACCESS(...) do { if (FECSAccessTracker::IsEnabled()) { FECSAccessTracker::Record<__VA_ARGS__>(); } } while (0)
+#else
+	#define ECS_RECORD_ACCESS(...) do {} while (0)
+#endif
+
+class UECSSystem;
+
+
+//////////////////////////////////////////////////
+enum class EECSAccess : uint8
+{
+	Read,
+	Write
+};
+
+//////////////////////////////////////////////////
+/**
+ * Debug helper that detects systems accessing the same pool at the same time from different threads, where at least one of them
+ * writes. Accesses are recorded when views, groups or entity accessors are used while a system runs, either in RunSystem() or
+ * in a task it launched. They are released when the system (or task) finishes.
+ *
+ * Conflicts are logged once and reported by the DiagnosticMessage() of the systems' tick functions.
+ */
+class UNREALENGINEECS_API FECSAccessTracker
+{
+public:
+	static bool IsEnabled() { return bEnabled; }
+
+	/** Marks the given system as running on the current thread. Pass nullptr to end it */
+	static void SetCurrentSystem(const UECSSystem* System);
+
+	/** Returns the system running on the current thread */
+	static const UECSSystem* GetCurrentSystem();
+
+	template<typename... Component>
+	static void Record()
+	{
+		if (GetCurrentSystem())
+		{
+			(RecordAccess(ECS::TypeId<Component>(), *GetPoolName<Component>(), std::is_const_v<Component> ? EECSAccess::Read : EECSAccess::Write), ...);
+		}
+	}
+
+	/** Records an access of the system running on the current thread */
+	static void RecordAccess(entt::id_type Pool, const TCHAR* PoolName, EECSAccess Access);
+
+	/** Returns the conflicts the given system was involved in */
+	static TArray<FString> GetConflicts(const UECSSystem* System);
+
+	/** Forgets the accesses and conflicts of the given system. Called when the system is deinitialized */
+	static void RemoveSystem(const UECSSystem* System);
+
+	/* Set through ecs.TrackAccess */
+	static bool bEnabled;
+
+private:
+	template<typename Component>
+	static const FString& GetPoolName()
+	{
+		static const FString Name = ECS::TypeName<Component>();
+		return Name;
+	}
+
+	/** Releases all accesses of the given system on the current thread */
+	static void ReleaseAccesses(const UECSSystem* System);
+};
+
+//////////////////////////////////////////////////
+/** Marks a system as running on the current thread for the lifetime of the scope */
+struct FECSAccessScope
+{
+	explicit FECSAccessScope(const UECSSystem* System)
+	{
+#if ECS_WITH_ACCESS_TRACKING
+		PreviousSystem = FECSAccessTracker::GetCurrentSystem();
+		FECSAccessTracker::SetCurrentSystem(System);
+#endif
+	}
+
+	~FECSAccessScope()
+	{
+#if ECS_WITH_ACCESS_TRACKING
+		FECSAccessTracker::SetCurrentSystem(PreviousSystem);
+#endif
+	}
+
+private:
+	const UECSSystem* PreviousSystem = nullptr;
+};
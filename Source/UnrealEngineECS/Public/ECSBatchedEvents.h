@@ -0,0 +1,136 @@
+// Copyright @Paul Larrass 2020
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "ECSIncludes.h"
+
+
+/** Delivers a packed array of entities. The array is only valid during the broadcast */
+DECLARE_MULTICAST_DELEGATE_OneParam(FECSEntityBatchDelegate, TArrayView<const entt::entity> /*Entities*/);
+
+
+//////////////////////////////////////////////////
+/** Base class of the per component event batches, so the registry can flush them without knowing their component type */
+class UNREALENGINEECS_API FECSBatchedEventsBase
+{
+public:
+	virtual ~FECSBatchedEventsBase() = default;
+
+	/** Delivers all events collected since the last flush */
+	virtual void Flush() = 0;
+
+	/** Returns the number of events waiting for the next flush */
+	virtual int32 GetNumPending() const = 0;
+};
+
+//////////////////////////////////////////////////
+/**
+ * Collects the construct, update and destroy events of one component type and delivers them once per frame as packed arrays.
+ * Each entity appears at most once per array and event type:
+ * - An entity that got the component and was updated in the same frame is only reported as constructed.
+ * - An entity that got the component and lost it again in the same frame is not reported at all.
+ *
+ * Events are delivered in the order destroy, construct, update. Destroyed entities may not exist anymore when they are delivered.
+ * Events caused by listeners during the delivery are delivered with the next flush.
+ *
+ * @see IECSRegistryInterface::BatchedEvents
+ */
+template<typename Component>
+class TECSBatchedEvents : public FECSBatchedEventsBase
+{
+public:
+	explicit TECSBatchedEvents(entt::registry& InRegistry)
+		: Registry(InRegistry)
+	{
+		Registry.on_construct<Component>().template connect<&TECSBatchedEvents::HandleConstruct>(*this);
+		Registry.on_update<Component>().template connect<&TECSBatchedEvents::HandleUpdate>(*this);
+		Registry.on_destroy<Component>().template connect<&TECSBatchedEvents::HandleDestroy>(*this);
+	}
+
+	virtual ~TECSBatchedEvents()
+	{
+		Registry.on_construct<Component>().disconnect(*this);
+		Registry.on_update<Component>().disconnect(*this);
+		Registry.on_destroy<Component>().disconnect(*this);
+	}
+
+	virtual void Flush() override
+	{
+		// Swap the batches, so events caused by listeners are collected for the next flush. The sets keep their capacity
+		std::swap(Constructed, DeliveringConstructed);
+		std::swap(Updated, DeliveringUpdated);
+		std::swap(Destroyed, DeliveringDestroyed);
+
+		Deliver(OnDestroy, DeliveringDestroyed);
+		Deliver(OnConstruct, DeliveringConstructed);
+		Deliver(OnUpdate, DeliveringUpdated);
+	}
+
+	virtual int32 GetNumPending() const override
+	{
+		return static_cast<int32>(Constructed.size() + Updated.size() + Destroyed.size());
+	}
+
+	/* Entities that got the component */
+	FECSEntityBatchDelegate OnConstruct;
+
+	/* Entities whose component was patched or replaced */
+	FECSEntityBatchDelegate OnUpdate;
+
+	/* Entities that lost the component */
+	FECSEntityBatchDelegate OnDestroy;
+
+private:
+	void HandleConstruct(entt::registry&, const entt::entity Entity)
+	{
+		if (!Constructed.contains(Entity))
+		{
+			Constructed.emplace(Entity);
+		}
+	}
+
+	void HandleUpdate(entt::registry&, const entt::entity Entity)
+	{
+		if (!Constructed.contains(Entity) && !Updated.contains(Entity))
+		{
+			Updated.emplace(Entity);
+		}
+	}
+
+	void HandleDestroy(entt::registry&, const entt::entity Entity)
+	{
+		if (Updated.contains(Entity))
+		{
+			Updated.remove(Entity);
+		}
+		
+		if (Constructed.contains(Entity))
+		{
+			Constructed.remove(Entity);
+		}
+		else if (!Destroyed.contains(Entity))
+		{
+			Destroyed.emplace(Entity);
+		}
+	}
+
+	static void Deliver(FECSEntityBatchDelegate& Delegate, entt::sparse_set& Entities)
+	{
+		if (Entities.size() > 0 && Delegate.IsBound())
+		{
+			Delegate.Broadcast(TArrayView<const entt::entity>(Entities.data(), Entities.size()));
+		}
+		Entities.clear();
+	}
+
+	entt::registry& Registry;
+
+	entt::sparse_set Constructed;
+	entt::sparse_set Updated;
+	entt::sparse_set Destroyed;
+
+	entt::sparse_set DeliveringConstructed;
+	entt::sparse_set DeliveringUpdated;
+	entt::sparse_set DeliveringDestroyed;
+};
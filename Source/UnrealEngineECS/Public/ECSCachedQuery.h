@@ -0,0 +1,169 @@
+// Copyright @Paul Larrass 2020
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "ECSRegistry.h"
+
+
+template<typename, typename...>
+class TECSCachedQuery;
+
+//////////////////////////////////////////////////
+/**
+ * Persistent query that keeps a packed list of all entities with the given components and without the excluded ones.
+ *
+ * Unlike a view, which tests every candidate against every pool each time it is iterated, the list is updated incrementally by
+ * the construct and destroy signals of the involved pools. Iterating it doesn't test any membership, so it pays off for views with
+ * many components or exclusions whose matching set rarely changes.
+ * Every change to the involved pools costs a few membership tests instead, so don't use it for pools with heavy churn.
+ *
+ * Create it once (e.g. in UECSSystem::Initialize) and keep it. It must not outlive the registry.
+ *
+ * @code{.cpp}
+ * TUniquePtr<TECSCachedQuery<TECSExclude<FDisabled>, FBuilding, FHealth, FOwner>> Query;
+ * Query = MakeUnique<TECSCachedQuery<TECSExclude<FDisabled>, FBuilding, FHealth, FOwner>>(*Registry);
+ * Query->Each([](entt::entity Entity, FBuilding& Building, FHealth& Health, FOwner& Owner) {});
+ * @endcode
+ *
+ * @tparam Component Types of (non empty) components an entity must have.
+ * @tparam Exclude Types of components an entity must not have.
+ */
+template<typename... Component, typename... Exclude>
+class TECSCachedQuery<TECSExclude<Exclude...>, Component...>
+{
+	static_assert(sizeof...(Component) > 0, "A query needs at least one component");
+	static_assert((!std::is_empty_v<Component> && ...), "Empty components can only be excluded");
+
+public:
+	explicit TECSCachedQuery(IECSRegistryInterface& InRegistry)
+		: Owner(InRegistry)
+		, Registry(InRegistry.GetEntTTReg())
+	{
+		(Registry.on_construct<Component>().template connect<&TECSCachedQuery::TryAdd>(*this), ...);
+		(Registry.on_destroy<Component>().template connect<&TECSCachedQuery::Remove>(*this), ...);
+		(Registry.on_construct<Exclude>().template connect<&TECSCachedQuery::Remove>(*this), ...);
+		(Registry.on_destroy<Exclude>().template connect<&TECSCachedQuery::template OnExcludeDestroyed<Exclude>>(*this), ...);
+
+		for (const entt::entity Entity : Registry.view<Component...>(TECSExclude<Exclude...>()))
+		{
+			Entities.emplace(Entity);
+		}
+	}
+
+	~TECSCachedQuery()
+	{
+		(Registry.on_construct<Component>().disconnect(*this), ...);
+		(Registry.on_destroy<Component>().disconnect(*this), ...);
+		(Registry.on_construct<Exclude>().disconnect(*this), ...);
+		(Registry.on_destroy<Exclude>().disconnect(*this), ...);
+	}
+
+	TECSCachedQuery(const TECSCachedQuery&) = delete;
+	TECSCachedQuery& operator=(const TECSCachedQuery&) = delete;
+
+	/**
+	 * Calls the function for each matching entity as void(entt::entity, Component&...).
+	 * The current entity may be removed from the query while iterating, e.g. by removing one of its components.
+	 */
+	template<typename Func>
+	void Each(Func Function) const
+	{
+		ECS_RECORD_ACCESS(Component...);
+		ECS_TRACE_SCOPE(TraceName(), Num());
+
+		// Backwards, so removing the current entity doesn't move an entity we haven't visited yet into its place
+		for (int32 Index = Num() - 1; Index >= 0; --Index)
+		{
+			const entt::entity Entity = Entities.data()[Index];
+			Function(Entity, Registry.get<Component>(Entity)...);
+		}
+	}
+
+	/**
+	 * Like Each(), but skips disabled entities and entities with a disabled component of the query (@see IECSRegistryInterface::SetEnabled).
+	 * When nothing is disabled, this is the same as Each().
+	 */
+	template<typename Func>
+	void EachEnabled(Func Function) const
+	{
+		const TArray<const FECSDisabledSet*, TInlineAllocator<8>> Disabled = Owner.GetDisabledSets<Component...>();
+		if (Disabled.Num() == 0)
+		{
+			Each(MoveTemp(Function));
+			return;
+		}
+
+		ECS_RECORD_ACCESS(Component...);
+		ECS_TRACE_SCOPE(TraceName(), Num());
+
+		for (int32 Index = Num() - 1; Index >= 0; --Index)
+		{
+			const entt::entity Entity = Entities.data()[Index];
+			if (!Disabled.ContainsByPredicate([Entity](const FECSDisabledSet* Set) { return Set->Contains(Entity); }))
+			{
+				Function(Entity, Registry.get<Component>(Entity)...);
+			}
+		}
+	}
+
+	/** Returns the number of matching entities */
+	int32 Num() const
+	{
+		return static_cast<int32>(Entities.size());
+	}
+
+	/** Does the entity match the query? */
+	bool Contains(entt::entity Entity) const
+	{
+		return Entities.contains(Entity);
+	}
+
+	/** Returns the packed array of matching entities */
+	TArrayView<const entt::entity> GetEntities() const
+	{
+		return TArrayView<const entt::entity>(Entities.data(), Num());
+	}
+
+private:
+#if ECS_WITH_QUERY_TRACE
+	static const ECS::Trace::FScopeName& TraceName()
+	{
+		static const ECS::Trace::FScopeName Name(sizeof...(Exclude) > 0
+			? FString::Printf(TEXT("ECS Cached query: %s Exclude: %s"), *ECS::Trace::ComponentSetName<Component...>(), *ECS::Trace::ComponentSetName<Exclude...>())
+			: FString::Printf(TEXT("ECS Cached query: %s"), *ECS::Trace::ComponentSetName<Component...>()));
+		return Name;
+	}
+#endif
+
+	void TryAdd(entt::registry&, const entt::entity Entity)
+	{
+		if (!Entities.contains(Entity) && Registry.has<Component...>(Entity) && (!Registry.has<Exclude>(Entity) && ...))
+		{
+			Entities.emplace(Entity);
+		}
+	}
+
+	void Remove(entt::registry&, const entt::entity Entity)
+	{
+		if (Entities.contains(Entity))
+		{
+			Entities.remove(Entity);
+		}
+	}
+
+	/** Called before Removed is removed, so we have to ignore it when testing the exclusions */
+	template<typename Removed>
+	void OnExcludeDestroyed(entt::registry&, const entt::entity Entity)
+	{
+		if (!Entities.contains(Entity) && Registry.has<Component...>(Entity)
+			&& ((std::is_same_v<Removed, Exclude> || !Registry.has<Exclude>(Entity)) && ...))
+		{
+			Entities.emplace(Entity);
+		}
+	}
+
+	const IECSRegistryInterface& Owner;
+	entt::registry& Registry;
+	entt::sparse_set Entities;
+};
@@ -0,0 +1,145 @@
+// Copyright @Paul Larrass 2020
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "ECSRegistry.h"
+#include "UEEnTTSystem.h"
+#include "ECSCollision.generated.h"
+
+
+//////////////////////////////////////////////////
+/** Sphere around the location of the entity's FTransform. The radius is scaled by the largest scale component */
+struct FECSSphereShape
+{
+	float Radius = 50.f;
+};
+
+/** Axis aligned box around the location of the entity's FTransform. The rotation is ignored, the extent is scaled */
+struct FECSBoxShape
+{
+	/* Half size of the box */
+	FVector Extent = FVector(50.f);
+};
+
+/**
+ * Optional collision filter. Two shapes collide when the layer of one is in the mask of the other.
+ * Shapes without a filter are on layer 1 and collide with everything.
+ */
+struct FECSCollisionFilter
+{
+	uint32 Layer = 1;
+	uint32 CollidesWith = ~0u;
+};
+
+/**
+ * Two entities whose shapes overlap. Each pair is reported once, A is the entity with the lower id. An entity with both a sphere
+ * and a box overlaps when either of its shapes does, but never with itself.
+ */
+struct FECSContactPair
+{
+	entt::entity A = entt::null;
+	entt::entity B = entt::null;
+};
+
+
+//////////////////////////////////////////////////
+struct FECSBroadphaseSettings
+{
+	/* Number of shapes per task when looking for pairs */
+	int32 ShapesPerTask = 2048;
+};
+
+//////////////////////////////////////////////////
+/**
+ * Sweep and prune broadphase over all entities with a FTransform and a FECSSphereShape or FECSBoxShape.
+ *
+ * Update() copies the bounds of all shapes into a packed array and sorts it along X. The sorted array is split into chunks that
+ * look for overlapping shapes in parallel, each into its own buffer. The buffers are concatenated into one packed array of pairs.
+ * Overlaps are exact for sphere/sphere, sphere/box and box/box. Shapes of the same entity don't overlap.
+ */
+class UNREALENGINEECS_API FECSBroadphase
+{
+public:
+	explicit FECSBroadphase(const FECSBroadphaseSettings& Settings = FECSBroadphaseSettings());
+
+	/** Finds all overlapping shapes. Only reads the registry, the pairs are valid until the next update */
+	void Update(IECSRegistryInterface& Registry);
+
+	/** Returns the pairs of the last update */
+	TArrayView<const FECSContactPair> GetPairs() const
+	{
+		return Pairs;
+	}
+
+	/** Returns the number of shapes of the last update */
+	int32 GetNumShapes() const
+	{
+		return Proxies.Num();
+	}
+
+private:
+	struct FProxy
+	{
+		FVector Min;
+		FVector Max;
+		FVector Center;
+
+		/* Scaled radius of spheres */
+		float Radius;
+		bool bSphere;
+
+		uint32 Layer;
+		uint32 CollidesWith;
+		entt::entity Entity;
+	};
+
+	template<typename Shape>
+	void AddProxies(IECSRegistryInterface& Registry);
+
+	/** Collects the pairs of the proxies [Begin, End) with all proxies after them */
+	void FindPairs(int32 Begin, int32 End, TArray<FECSContactPair>& OutPairs) const;
+
+	static bool Overlap(const FProxy& First, const FProxy& Second);
+
+	FECSBroadphaseSettings Settings;
+
+	/* Sorted by Min.X after the update */
+	TArray<FProxy> Proxies;
+
+	/* Does an entity have two proxies in this update? Then the pairs of its shapes have to be merged */
+	bool bMultipleShapesPerEntity = false;
+
+	/* Pairs per task. Kept between updates, so they keep their capacity */
+	TArray<TArray<FECSContactPair>> TaskPairs;
+
+	TArray<FECSContactPair> Pairs;
+};
+
+
+//////////////////////////////////////////////////
+//////////////////////////////////////////////////
+/**
+ * Runs the broadphase each frame, after the transforms of the ECS were written back (@see UECSCopyTransformToActor), so the pairs
+ * match the final transforms of the frame.
+ * Systems that consume the pairs should add this system as prerequisite, or run early in the next frame.
+ */
+UCLASS()
+class UNREALENGINEECS_API UECSBroadphaseSystem : public UECSSystem
+{
+	GENERATED_BODY()
+
+public:
+	UECSBroadphaseSystem();
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void RunSystem(float DeltaTime, ENamedThreads::Type CurrentThread) const override;
+
+	/** Returns the pairs of the last run */
+	TArrayView<const FECSContactPair> GetPairs() const
+	{
+		return Broadphase.GetPairs();
+	}
+
+private:
+	mutable FECSBroadphase Broadphase;
+};
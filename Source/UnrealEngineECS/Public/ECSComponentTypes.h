@@ -0,0 +1,297 @@
+// Copyright @Paul Larrass 2020
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "ECSRegistry.h"
+#include "Serialization/Archive.h"
+
+
+//////////////////////////////////////////////////
+/** Receives the construct, update and destroy signals of all registered component types. @see FECSComponentType::Connect */
+class UNREALENGINEECS_API IECSComponentListener
+{
+public:
+	virtual ~IECSComponentListener() = default;
+
+	virtual void OnComponentConstructed(entt::id_type Type, entt::registry& Registry, entt::entity Entity) = 0;
+	virtual void OnComponentUpdated(entt::id_type Type, entt::registry& Registry, entt::entity Entity) = 0;
+	virtual void OnComponentDestroyed(entt::id_type Type, entt::registry& Registry, entt::entity Entity) = 0;
+};
+
+
+//////////////////////////////////////////////////
+/**
+ * Type erased operations for one component type.
+ * Used by features that handle components without knowing their type at compile time, e.g. importing entities from data files.
+ */
+struct UNREALENGINEECS_API FECSComponentType
+{
+	/* Id of the component type. @see ECS::TypeId */
+	entt::id_type Id = 0;
+
+	/* Name under which the type was registered */
+	FName Name;
+
+	/* Reflection data of the component or nullptr. Must describe the same memory layout as the C++ type, so only native structs are valid */
+	UScriptStruct* Struct = nullptr;
+
+	/* Moves the Count components in Data (an array of initialized instances) to the given entities. Data is left in a moved-from state */
+	void (*Insert)(IECSRegistryInterface& Registry, const entt::entity* Entities, void* Data, int32 Count) = nullptr;
+
+	/* Reserves space for Count components in the pool of this type */
+	void (*Reserve)(IECSRegistryInterface& Registry, int32 Count) = nullptr;
+
+	/* Writes the component of the entity. Trivially copyable types are written as raw bytes, others through Struct. Nothing for empty types */
+	void (*Save)(const FECSComponentType& Type, IECSRegistryInterface& Registry, entt::entity Entity, FArchive& Ar) = nullptr;
+
+	/* Reads a component written by Save and adds or replaces it. nullptr if the type isn't default constructible */
+	void (*Load)(const FECSComponentType& Type, IECSRegistryInterface& Registry, entt::entity Entity, FArchive& Ar) = nullptr;
+
+	/*
+	 * Moves the components of Count source entities, which must all have one, to the target entities with the same index, in one
+	 * batch. The source components are left in a moved-from state. @see ECS::MigrateEntities
+	 */
+	void (*Move)(IECSRegistryInterface& Source, IECSRegistryInterface& Target, const entt::entity* SourceEntities,
+				 const entt::entity* TargetEntities, int32 Count) = nullptr;
+
+	/* Removes the component from the entity, if it has it */
+	void (*Remove)(entt::registry& Registry, entt::entity Entity) = nullptr;
+
+	/* Tracks the pool of this type in the statistics of the registry. @see FECSStats::TrackPool */
+	void (*TrackPool)(FECSStats& Stats, entt::registry& Registry) = nullptr;
+
+	/* Connects the listener to the construct, update and destroy signals of this type */
+	void (*Connect)(entt::registry& Registry, IECSComponentListener& Listener) = nullptr;
+	void (*Disconnect)(entt::registry& Registry, IECSComponentListener& Listener) = nullptr;
+
+	/* Can the value of the component be saved? */
+	bool CanSerialize() const
+	{
+		return bTriviallyCopyable || bEmpty || Struct;
+	}
+
+	bool bTriviallyCopyable = false;
+	bool bEmpty = false;
+};
+
+
+//////////////////////////////////////////////////
+/**
+ * Registry of all component types that can be handled type erased. Register your components during module startup.
+ */
+class UNREALENGINEECS_API FECSComponentTypes
+{
+public:
+	/**
+	 * Registers the given component type.
+	 * @param Name		Name of the type, e.g. used as column prefix in import files
+	 * @param Struct	Reflection data of the type, needed to import the type from data files
+	 */
+	template<typename Component>
+	static const FECSComponentType& Register(FName Name, UScriptStruct* Struct = nullptr)
+	{
+		FECSComponentType Type;
+		Type.Id = ECS::TypeId<Component>();
+		Type.Name = Name;
+		Type.Struct = Struct;
+		Type.Insert = [](IECSRegistryInterface& Registry, const entt::entity* Entities, void* Data, int32 Count)
+		{
+			Component* Components = static_cast<Component*>(Data);
+			Registry.GetEntTTReg().insert<Component>(Entities, Entities + Count, std::make_move_iterator(Components),
+													 std::make_move_iterator(Components + Count));
+		};
+		Type.Reserve = [](IECSRegistryInterface& Registry, int32 Count)
+		{
+			Registry.Reserve<Component>(Registry.Size<Component>() + Count);
+		};
+		Type.bTriviallyCopyable = std::is_trivially_copyable_v<Component>;
+		Type.bEmpty = std::is_empty_v<Component>;
+		Type.Save = [](const FECSComponentType& Type, IECSRegistryInterface& Registry, entt::entity Entity, FArchive& Ar)
+		{
+			if constexpr (!std::is_empty_v<Component>)
+			{
+				Serialize(Type, Ar, Registry.GetEntTTReg().get<Component>(Entity));
+			}
+		};
+		if constexpr (std::is_default_constructible_v<Component>)
+		{
+			Type.Load = [](const FECSComponentType& Type, IECSRegistryInterface& InRegistry, entt::entity Entity, FArchive& Ar)
+			{
+				entt::registry& Registry = InRegistry.GetEntTTReg();
+				if constexpr (std::is_empty_v<Component>)
+				{
+					if (!Registry.has<Component>(Entity))
+					{
+						Registry.emplace<Component>(Entity);
+					}
+				}
+				else
+				{
+					Component Value{};
+					Serialize(Type, Ar, Value);
+					Registry.emplace_or_replace<Component>(Entity, MoveTemp(Value));
+				}
+			};
+		}
+		Type.Move = [](IECSRegistryInterface& InSource, IECSRegistryInterface& InTarget, const entt::entity* SourceEntities,
+					   const entt::entity* TargetEntities, int32 Count)
+		{
+			entt::registry& Source = InSource.GetEntTTReg();
+			entt::registry& Target = InTarget.GetEntTTReg();
+			if constexpr (std::is_empty_v<Component>)
+			{
+				Target.insert<Component>(TargetEntities, TargetEntities + Count);
+			}
+			else
+			{
+				TArray<Component> Values;
+				Values.Reserve(Count);
+				for (int32 Index = 0; Index < Count; ++Index)
+				{
+					Values.Add(MoveTemp(Source.get<Component>(SourceEntities[Index])));
+				}
+				Target.insert<Component>(TargetEntities, TargetEntities + Count, std::make_move_iterator(Values.GetData()),
+										 std::make_move_iterator(Values.GetData() + Count));
+			}
+		};
+		Type.Remove = [](entt::registry& Registry, entt::entity Entity)
+		{
+			Registry.remove_if_exists<Component>(Entity);
+		};
+		Type.TrackPool = [](FECSStats& Stats, entt::registry& Registry)
+		{
+			Stats.TrackPool<Component>(Registry);
+		};
+		SetSignals<Component>(Type);
+		return Add(MoveTemp(Type));
+	}
+
+	/**
+	 * Registers a shared value type (@see TECSSharedStore). The type operates on the TECSShared<T> of the entities, but imports,
+	 * saves and loads the values, which are set through IECSRegistryInterface::Shared().
+	 * @param Name		Name of the type, e.g. used as column prefix in import files
+	 * @param Struct	Reflection data of T, needed to import the type from data files
+	 */
+	template<typename T>
+	static const FECSComponentType& RegisterShared(FName Name, UScriptStruct* Struct = nullptr)
+	{
+		static_assert(std::is_default_constructible_v<T>, "Shared values must be default constructible");
+
+		FECSComponentType Type;
+		Type.Id = ECS::TypeId<TECSShared<T>>();
+		Type.Name = Name;
+		Type.Struct = Struct;
+		Type.Insert = [](IECSRegistryInterface& Registry, const entt::entity* Entities, void* Data, int32 Count)
+		{
+			TECSSharedStore<T>& Store = Registry.Shared<T>();
+			const T* Values = static_cast<const T*>(Data);
+			for (int32 Index = 0; Index < Count; ++Index)
+			{
+				Store.Set(Entities[Index], Values[Index]);
+			}
+		};
+		Type.Reserve = [](IECSRegistryInterface& Registry, int32 Count)
+		{
+			Registry.Reserve<TECSShared<T>>(Registry.Size<TECSShared<T>>() + Count);
+		};
+		Type.bTriviallyCopyable = std::is_trivially_copyable_v<T>;
+		Type.Save = [](const FECSComponentType& Type, IECSRegistryInterface& Registry, entt::entity Entity, FArchive& Ar)
+		{
+			T Value = Registry.Shared<T>().GetForEntity(Entity);
+			Serialize(Type, Ar, Value);
+		};
+		Type.Load = [](const FECSComponentType& Type, IECSRegistryInterface& Registry, entt::entity Entity, FArchive& Ar)
+		{
+			T Value{};
+			Serialize(Type, Ar, Value);
+			Registry.Shared<T>().Set(Entity, Value);
+		};
+		Type.Move = [](IECSRegistryInterface& Source, IECSRegistryInterface& Target, const entt::entity* SourceEntities,
+					   const entt::entity* TargetEntities, int32 Count)
+		{
+			// The indices are local to each registry, so the values are set again. The source values are released with the entities
+			const TECSSharedStore<T>& SourceStore = Source.Shared<T>();
+			TECSSharedStore<T>& TargetStore = Target.Shared<T>();
+			for (int32 Index = 0; Index < Count; ++Index)
+			{
+				TargetStore.Set(TargetEntities[Index], SourceStore.GetForEntity(SourceEntities[Index]));
+			}
+		};
+		Type.Remove = [](entt::registry& Registry, entt::entity Entity)
+		{
+			Registry.remove_if_exists<TECSShared<T>>(Entity);
+		};
+		Type.TrackPool = [](FECSStats& Stats, entt::registry& Registry)
+		{
+			Stats.TrackPool<TECSShared<T>>(Registry);
+		};
+		SetSignals<TECSShared<T>>(Type);
+		return Add(MoveTemp(Type));
+	}
+
+	/** Returns all registered types */
+	static TArray<const FECSComponentType*> GetAll();
+
+	/** Returns the type with the given id or nullptr if it wasn't registered */
+	static const FECSComponentType* Find(entt::id_type Id);
+
+	/** Returns the type with the given name or nullptr if it wasn't registered */
+	static const FECSComponentType* Find(FName Name);
+
+	/** Removes all registered types. Called on module shutdown */
+	static void Reset();
+
+private:
+	static const FECSComponentType& Add(FECSComponentType&& Type);
+
+	template<typename Component>
+	static void SetSignals(FECSComponentType& Type)
+	{
+		Type.Connect = [](entt::registry& Registry, IECSComponentListener& Listener)
+		{
+			Registry.on_construct<Component>().template connect<&ForwardConstruct<Component>>(Listener);
+			Registry.on_update<Component>().template connect<&ForwardUpdate<Component>>(Listener);
+			Registry.on_destroy<Component>().template connect<&ForwardDestroy<Component>>(Listener);
+		};
+		Type.Disconnect = [](entt::registry& Registry, IECSComponentListener& Listener)
+		{
+			Registry.on_construct<Component>().disconnect(Listener);
+			Registry.on_update<Component>().disconnect(Listener);
+			Registry.on_destroy<Component>().disconnect(Listener);
+		};
+	}
+
+	template<typename Component>
+	static void Serialize(const FECSComponentType& Type, FArchive& Ar, Component& Value)
+	{
+		if constexpr (std::is_trivially_copyable_v<Component>)
+		{
+			Ar.Serialize(&Value, sizeof(Component));
+		}
+		else if (Type.Struct)
+		{
+			Type.Struct->SerializeBin(Ar, &Value);
+		}
+	}
+
+	template<typename Component>
+	static void ForwardConstruct(IECSComponentListener& Listener, entt::registry& Registry, const entt::entity Entity)
+	{
+		Listener.OnComponentConstructed(ECS::TypeId<Component>(), Registry, Entity);
+	}
+
+	template<typename Component>
+	static void ForwardUpdate(IECSComponentListener& Listener, entt::registry& Registry, const entt::entity Entity)
+	{
+		Listener.OnComponentUpdated(ECS::TypeId<Component>(), Registry, Entity);
+	}
+
+	template<typename Component>
+	static void ForwardDestroy(IECSComponentListener& Listener, entt::registry& Registry, const entt::entity Entity)
+	{
+		Listener.OnComponentDestroyed(ECS::TypeId<Component>(), Registry, Entity);
+	}
+
+	static TMap<entt::id_type, TUniquePtr<FECSComponentType>> Types;
+};
@@ -18,10 +18,34 @@ public:
 	 *
 	 * After the Super:: call, add the ECS component to the entity here: EntityHandle.AddComponent<Component>();
 	 * 
-	 * This will be called in BeginPlay().
+	 * This will be called in BeginPlay(), or when registered in a batch (@see ecs.BatchRegistration), at the start of the next world
+	 * tick together with all other wrappers that began play in the meantime. In that case EntityHandle is already set.
+	 * A batched wrapper is registered right away when GetEntityHandle() is called before that.
 	 * You don't need to call the base implementation, because the UECS_BridgeComponent is setting EntityHandle for other components */
 	virtual void RegisterComponentWithECS();
 
-	/* The entity that we are representing. Only valid after RegisterComponentWithECS() was called */
+	/**
+	 * Reserves space for the ECS components that the given instances of this class will add in RegisterComponentWithECS().
+	 * Called on one instance per class before a batch of registrations, with all instances of the class in the batch, so
+	 * requirements that depend on the settings of each instance can be summed up.
+	 */
+	virtual void ReserveECSComponents(class IECSRegistryInterface& Registry, TArrayView<UECSComponentWrapper* const> Instances) const {}
+
+	/**
+	 * Wrappers of classes with a lower priority are registered first in a batch, e.g. the bridge component that adds the
+	 * FActorPtrComponent other wrappers rely on. Must be the same for all instances of a class.
+	 */
+	virtual int32 GetRegistrationPriority() const { return 0; }
+
+	/** Has this component been registered with the ECS yet? */
+	bool IsRegisteredWithECS() const { return EntityHandle != FEntity::NullEntity; }
+
+	/** Returns the entity, registers this component first if it is still queued for a batch registration */
+	const FEntity& GetEntityHandle();
+
+	/**
+	 * The entity that we are representing. Only valid after RegisterComponentWithECS() was called, use GetEntityHandle() if this
+	 * component may still be queued for a batch registration
+	 */
 	FEntity EntityHandle;
 };
@@ -5,7 +5,7 @@
 #include "ECSCoreSystems.generated.h"
 
 /**
- * Copy transforms from actors to the ECS
+ * Copy transforms from actors to the ECS. Only entities tagged with FActorTransformChanged are synced
  */
 UCLASS()
 class UECSCopyTransformToECS : public UECSSystem
@@ -14,19 +14,16 @@ class UECSCopyTransformToECS : public UECSSystem
 
 public:
 	UECSCopyTransformToECS();
-	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
-	virtual void Deinitialize() override;
 	virtual void RunSystem(float DeltaTime, ENamedThreads::Type CurrentThread) const override;
-
-protected:
-	FECSObserver Observer;
 };
 
 
 //////////////////////////////////////////////////
 //////////////////////////////////////////////////
 /**
- * Copy transforms from the ECS to the linked actor
+ * Copy transforms from the ECS to the linked actor.
+ * Rebuilds the FTransform of entities with split transform components (FECSPosition etc.) and then iterates the core group which
+ * owns FActorPtrComponent, FTransform and TECSShared<FSyncTransformToActor>
  */
 UCLASS()
 class UECSCopyTransformToActor : public UECSSystem
@@ -0,0 +1,69 @@
+// Copyright @Paul Larrass 2020
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "ECSIncludes.h"
+
+
+//////////////////////////////////////////////////
+/**
+ * Set of disabled entities, indexed by the entity index, with an O(1) membership test and O(1) toggles.
+ *
+ * Instead of a single bit, the full identifier is stored per index. The test is still one load and compare, but an entity that
+ * reuses the index of a destroyed, disabled entity doesn't inherit its state, even when it was destroyed directly through EnTT.
+ * Nothing is added to or removed from any pool, so toggling doesn't fire any signals.
+ */
+class FECSDisabledSet
+{
+public:
+	bool Contains(const entt::entity Entity) const
+	{
+		const int32 Index = GetIndex(Entity);
+		return Index < Slots.Num() && Slots[Index] == Entity;
+	}
+
+	void Add(const entt::entity Entity)
+	{
+		const int32 Index = GetIndex(Entity);
+		if (Index >= Slots.Num())
+		{
+			const int32 OldNum = Slots.Num();
+			Slots.SetNumUninitialized(Index + 1);
+			for (int32 Slot = OldNum; Slot < Slots.Num(); ++Slot)
+			{
+				Slots[Slot] = entt::null;
+			}
+		}
+
+		NumUsed += Slots[Index] == entt::null ? 1 : 0;
+		Slots[Index] = Entity;
+	}
+
+	void Remove(const entt::entity Entity)
+	{
+		if (Contains(Entity))
+		{
+			Slots[GetIndex(Entity)] = entt::null;
+			--NumUsed;
+		}
+	}
+
+	/**
+	 * Is nothing disabled? IECSRegistryInterface::Destroy() frees the slots of destroyed entities, slots of entities destroyed
+	 * directly through EnTT count as used until their index is disabled again
+	 */
+	bool IsEmpty() const
+	{
+		return NumUsed == 0;
+	}
+
+private:
+	static int32 GetIndex(const entt::entity Entity)
+	{
+		return static_cast<int32>(entt::to_integral(Entity) & entt::entt_traits<std::underlying_type_t<entt::entity>>::entity_mask);
+	}
+
+	TArray<entt::entity> Slots;
+	int32 NumUsed = 0;
+};
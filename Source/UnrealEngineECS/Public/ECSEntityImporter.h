@@ -0,0 +1,111 @@
+// Copyright @Paul Larrass 2020
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Tickable.h"
+#include "ECSRegistry.h"
+
+struct FECSComponentType;
+class IFileHandle;
+
+
+//////////////////////////////////////////////////
+struct FECSImportSettings
+{
+	/* Number of bytes read from the file at once */
+	int32 ChunkSize = 64 * 1024;
+
+	/* Number of entities that are created together, at least 1. Components are added per type for the whole batch */
+	int32 BatchSize = 1024;
+
+	/* Time in milliseconds that the importer may spend each frame when it's ticking automatically */
+	float TimeBudgetMs = 2.f;
+};
+
+//////////////////////////////////////////////////
+/**
+ * Streams entities from a CSV file into a registry, spread over multiple frames.
+ *
+ * The first line of the file is a header. Each column is either "Component" or "Component.Property", where Component is the name
+ * under which the type was registered in FECSComponentTypes (with reflection data) and Property a property of that struct.
+ * Values use Unreal's text export format, e.g. "(X=1.0,Y=2.0,Z=0.0)", so quote them when they contain commas.
+ * Every other line is one entity. Components of columns that are empty keep their default values.
+ *
+ * The file is read in chunks of FECSImportSettings::ChunkSize. Rows are converted in batches and each batch creates all of its
+ * entities at once and then inserts the components type by type.
+ */
+class UNREALENGINEECS_API FECSEntityImporter : public FTickableGameObject
+{
+public:
+	FECSEntityImporter(IECSRegistryInterface& Registry, const FECSImportSettings& Settings = FECSImportSettings());
+	virtual ~FECSEntityImporter();
+
+	/**
+	 * Opens the file and reads its header.
+	 * @param bTickAutomatically When true, the importer imports rows each frame within the time budget until it's done
+	 * @return False when the file couldn't be opened or the header references unknown components or properties
+	 */
+	bool Open(const FString& FilePath, bool bTickAutomatically = true);
+
+	/**
+	 * Imports rows until the time budget is used up or the file is done.
+	 * @return True when the whole file was imported
+	 */
+	bool Import(double TimeBudgetSeconds);
+
+	/** Has the whole file been imported? */
+	bool IsDone() const;
+
+	/** Returns the number of entities that were created so far */
+	int32 GetNumImported() const { return NumImported; }
+
+	/** Called once after the last batch was imported */
+	FSimpleMulticastDelegate OnFinished;
+
+	//~ Begin FTickableGameObject Interface
+	virtual void Tick(float DeltaTime) override;
+	virtual bool IsTickable() const override;
+	virtual TStatId GetStatId() const override;
+	//~ End FTickableGameObject Interface
+
+private:
+	/** Reads the next chunk of the file and splits it into rows. Returns false when the end of the file is reached */
+	bool ReadChunk();
+
+	/** Creates the entities for the parsed rows */
+	void CreateBatch();
+
+	void Close();
+
+	static void ParseLine(const FString& Line, TArray<FString>& OutFields);
+
+	struct FColumn
+	{
+		/* Index into Components */
+		int32 ComponentIndex = INDEX_NONE;
+
+		/* Property to import into or nullptr when the whole struct is imported */
+		FProperty* Property = nullptr;
+	};
+
+	IECSRegistryInterface& Registry;
+	FECSImportSettings Settings;
+
+	TUniquePtr<IFileHandle> File;
+	FString FilePath;
+
+	/* Component types referenced by the header */
+	TArray<const FECSComponentType*> Components;
+	TArray<FColumn> Columns;
+
+	/* Bytes of the current chunk that don't form a complete line yet */
+	TArray<ANSICHAR> PendingBytes;
+
+	/* Parsed rows that are waiting for the next batch */
+	TArray<TArray<FString>> PendingRows;
+
+	bool bEndOfFile = true;
+	bool bTickAutomatically = false;
+	int32 NumImported = 0;
+};
@@ -0,0 +1,50 @@
+// Copyright @Paul Larrass 2020
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UEEnTTComponents.h"
+
+
+/**
+ * Operations on hierarchies built from FRelationship components. Unlike IECSRegistryInterface::Destroy(), they keep the links of the
+ * remaining entities intact.
+ */
+namespace ECS::Hierarchy
+{
+	/** Unlinks the entity from its parent and siblings. Its own children stay attached to it. O(1) */
+	UNREALENGINEECS_API void Detach(IECSRegistryInterface& Registry, FEntityId Entity);
+
+	/**
+	 * Moves all given entities to the new parent, in the given order after the existing children of the parent.
+	 * Entities and parent get a FRelationship component if they don't have one yet. When NewParent is null, the entities are only
+	 * detached. Does nothing and logs an error if the new parent is one of the entities or a descendant of them.
+	 * O(number of entities * depth of the new parent + existing children of the new parent)
+	 */
+	UNREALENGINEECS_API void Reparent(IECSRegistryInterface& Registry, TArrayView<const FEntityId> Entities, FEntityId NewParent);
+
+	/** Collects all descendants of the given entity (children first, then their children and so on) */
+	UNREALENGINEECS_API void GetDescendants(IECSRegistryInterface& Registry, FEntityId Entity, TArray<entt::entity>& OutDescendants);
+
+	/**
+	 * Destroys the given entities together with all of their descendants. The roots are detached first, so their former parents
+	 * and siblings stay valid. All entities are destroyed in one batch.
+	 * @return The number of destroyed entities
+	 */
+	UNREALENGINEECS_API int32 DestroySubtrees(IECSRegistryInterface& Registry, TArrayView<const FEntityId> Roots);
+
+	/**
+	 * Checks the links of all FRelationship components: referenced entities must exist and have a FRelationship, sibling links must
+	 * be mutual, first children must have no previous sibling and all children must point back to their parent.
+	 * Logs every broken link.
+	 * @return True if the hierarchy is intact
+	 */
+	UNREALENGINEECS_API bool Validate(IECSRegistryInterface& Registry);
+
+	/**
+	 * Sets all links to destroyed entities to null. Only compares versions, so it's cheap enough to run every frame.
+	 * This doesn't repair the sibling list, use DestroySubtrees() to destroy entities in a hierarchy.
+	 * @return The number of links that were cleared
+	 */
+	UNREALENGINEECS_API int32 ClearStaleLinks(IECSRegistryInterface& Registry);
+}
@@ -1,6 +1,27 @@
 ﻿#pragma once
 
+#include "CoreMinimal.h"
+
 // Single include file:
 // #include "ThirdParty/EnTT/entt/single_include/entt/entt.hpp"
 
 #include "ThirdParty/EnTT/entt/src/entt/entt.hpp"
+
+
+namespace ECS
+{
+	/** Returns the stable id of the given component type. Equal across modules, so it can be used as a key in shared maps */
+	template<typename Component>
+	entt::id_type TypeId()
+	{
+		return entt::type_info<std::decay_t<Component>>::id();
+	}
+
+	/** Returns the name of the given component type, for logging and diagnostics */
+	template<typename Component>
+	FString TypeName()
+	{
+		const std::string_view Name = entt::type_info<std::decay_t<Component>>::name();
+		return FString(Name.size(), Name.data());
+	}
+}
@@ -0,0 +1,31 @@
+// Copyright @Paul Larrass 2020
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "ECSRegistry.h"
+#include "UEEnTTEntity.h"
+
+
+//////////////////////////////////////////////////
+namespace ECS
+{
+	/**
+	 * Moves the given entities with all of their components to another registry, e.g. to offload a dormant region of the world to a
+	 * background registry that is ticked at a lower rate.
+	 *
+	 * The target entities are created in one batch and each component type is moved in one batch. The source entities are destroyed.
+	 * Links of FRelationship components are remapped to the new entities. Entities whose parent or children are not moved with them are
+	 * detached first, so the hierarchies in both registries stay intact (@see ECS::Hierarchy::GetDescendants to move whole subtrees).
+	 * The enabled state of the entities and of their components is kept.
+	 *
+	 * Only components registered in FECSComponentTypes (including shared values, @see FECSComponentTypes::RegisterShared) and
+	 * FRelationship can be moved. Other components, e.g. actor pointers, are dropped with a warning. The plugin registers its own
+	 * components on startup, tags of the game are only moved when their types are registered.
+	 * Must not be called while either registry is iterated.
+	 *
+	 * @return Mapping of the source entities to the new entities in Target
+	 */
+	UNREALENGINEECS_API TMap<FEntityId, FEntityId> MigrateEntities(IECSRegistryInterface& Source, IECSRegistryInterface& Target,
+																   TArrayView<const entt::entity> Entities);
+}
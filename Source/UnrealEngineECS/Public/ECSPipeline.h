@@ -0,0 +1,164 @@
+// Copyright @Paul Larrass 2020
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "ECSRegistry.h"
+
+
+//////////////////////////////////////////////////
+/**
+ * Component access of a pipeline stage. Stages with the same query (the same components in the same order, including const) are
+ * fused into one loop.
+ */
+template<typename... Component>
+struct TECSStageQuery
+{
+	static_assert(sizeof...(Component) > 0, "A stage needs at least one component");
+
+	/** Calls the function for each enabled entity as void(entt::entity, Component&...), without the empty components */
+	template<typename Func>
+	static void Each(IECSRegistryInterface& Registry, Func Function)
+	{
+		Registry.EachEnabled(Registry.View<Component...>(), Function);
+	}
+};
+
+/**
+ * Base of pipeline stages. Derive from it with the components the stage accesses and implement
+ * void Run(float DeltaTime, entt::entity Entity, Component&... Components) const
+ * The empty components of the query (tags) are not passed to Run().
+ */
+template<typename... Component>
+struct TECSStage
+{
+	using FQuery = TECSStageQuery<Component...>;
+};
+
+//////////////////////////////////////////////////
+/**
+ * A list of per-entity stages that is defined at compile time and runs as one unit, e.g. from the RunSystem() of a single system.
+ *
+ * Adjacent stages with the same query are fused: the view is iterated once and all of them run on each entity before the next entity
+ * is visited, so the components are loaded once instead of once per stage. Stages that don't share the query of their neighbour get
+ * their own loop. The order of the stages is kept, but a fused stage sees the results of the earlier stages only for the same entity,
+ * so stages must not read other entities' components written by the stages they are fused with.
+ *
+ * @code{.cpp}
+ * struct FApplyDrag : TECSStage<FECSVelocity>
+ * {
+ *     void Run(float DeltaTime, entt::entity Entity, FECSVelocity& Velocity) const { Velocity.Value *= 1.f - Drag * DeltaTime; }
+ *     float Drag = 0.1f;
+ * };
+ * struct FApplyGravity : TECSStage<FECSVelocity> { ... };
+ *
+ * // One loop over all velocities that runs both stages
+ * TECSPipeline<FApplyDrag, FApplyGravity> Pipeline;
+ * ReportProcessedEntities(Pipeline.Run(*Registry, DeltaTime));
+ * @endcode
+ */
+template<typename... Stages>
+class TECSPipeline
+{
+	static_assert(sizeof...(Stages) > 0, "A pipeline needs at least one stage");
+
+public:
+	TECSPipeline() = default;
+
+	explicit TECSPipeline(Stages&&... InStages)
+		: StageInstances(MoveTemp(InStages)...)
+	{
+	}
+
+	/**
+	 * Runs all stages.
+	 * @return The number of entities visited, summed over all loops
+	 */
+	int32 Run(IECSRegistryInterface& Registry, float DeltaTime) const
+	{
+		int32 NumVisited = 0;
+		RunFrom<0>(Registry, DeltaTime, NumVisited);
+		return NumVisited;
+	}
+
+	/** Returns the given stage, e.g. to change its settings */
+	template<size_t Index>
+	auto& GetStage()
+	{
+		return std::get<Index>(StageInstances);
+	}
+
+	/** Returns the number of loops the stages are fused into */
+	static constexpr int32 NumLoops()
+	{
+		return CountLoops<0>();
+	}
+
+private:
+	template<size_t Index>
+	using TStage = std::tuple_element_t<Index, std::tuple<Stages...>>;
+
+	template<size_t Index>
+	static constexpr bool SharesQueryWithPrevious()
+	{
+		if constexpr (Index == 0)
+		{
+			return false;
+		}
+		else
+		{
+			return std::is_same_v<typename TStage<Index - 1>::FQuery, typename TStage<Index>::FQuery>;
+		}
+	}
+
+	/** Returns the index after the last stage that is fused with the stage at Begin */
+	template<size_t Begin>
+	static constexpr size_t FusedEnd()
+	{
+		if constexpr (Begin + 1 < sizeof...(Stages) && SharesQueryWithPrevious<Begin + 1>())
+		{
+			return FusedEnd<Begin + 1>();
+		}
+		else
+		{
+			return Begin + 1;
+		}
+	}
+
+	template<size_t Begin>
+	static constexpr int32 CountLoops()
+	{
+		if constexpr (Begin < sizeof...(Stages))
+		{
+			return 1 + CountLoops<FusedEnd<Begin>()>();
+		}
+		else
+		{
+			return 0;
+		}
+	}
+
+	template<size_t Begin>
+	void RunFrom(IECSRegistryInterface& Registry, float DeltaTime, int32& NumVisited) const
+	{
+		if constexpr (Begin < sizeof...(Stages))
+		{
+			constexpr size_t End = FusedEnd<Begin>();
+			RunFused<Begin>(Registry, DeltaTime, NumVisited, std::make_index_sequence<End - Begin>());
+			RunFrom<End>(Registry, DeltaTime, NumVisited);
+		}
+	}
+
+	/** One loop over the shared query, running the stages [Begin, Begin + sizeof...(Offset)) on each entity */
+	template<size_t Begin, size_t... Offset>
+	void RunFused(IECSRegistryInterface& Registry, float DeltaTime, int32& NumVisited, std::index_sequence<Offset...>) const
+	{
+		TStage<Begin>::FQuery::Each(Registry, [this, DeltaTime, &NumVisited](const entt::entity Entity, auto&... Components)
+		{
+			(std::get<Begin + Offset>(StageInstances).Run(DeltaTime, Entity, Components...), ...);
+			++NumVisited;
+		});
+	}
+
+	std::tuple<Stages...> StageInstances;
+};
@@ -3,7 +3,16 @@
 
 #include "CoreMinimal.h"
 #include "Subsystems/GameInstanceSubsystem.h"
+#include "Engine/EngineBaseTypes.h"
 #include "ECSIncludes.h"
+#include "ECSTags.h"
+#include "ECSBatchedEvents.h"
+#include "ECSSnapshot.h"
+#include "ECSAccessTracker.h"
+#include "ECSTrace.h"
+#include "ECSDisabledSet.h"
+#include "ECSSharedComponents.h"
+#include "ECSStats.h"
 #include "ECSRegistry.generated.h"
 
 
@@ -35,6 +44,9 @@ class UNREALENGINEECS_API IECSRegistryInterface
 	friend struct FEntity;
 
 public:	
+	/** Disconnects the observers that are still connected, @see DisconnectObservers */
+	~IECSRegistryInterface();
+
 	/**
 	 * @brief Returns the number of existing components of the given type.
 	 * @tparam Component Type of component of which to return the size.
@@ -63,6 +75,27 @@ public:
 	template<typename... Component>
 	[[nodiscard]] bool Empty() const;
 
+	/**
+	 * Reserves space in the pools of the given components, e.g. before a spawn wave, so the pools don't reallocate while growing.
+	 * @param Capacity Number of components the pools should be able to hold.
+	 */
+	template<typename... Component>
+	void Reserve(int32 Capacity);
+
+	/**
+	 * Returns the number of components the pool of the given type can hold without reallocating.
+	 * Together with Size<Component>() this tells how much of the pool is unused.
+	 */
+	template<typename Component>
+	[[nodiscard]] int32 Capacity() const;
+
+	/**
+	 * Releases unused memory of the pools of the given components, e.g. after a large number of entities was destroyed.
+	 * Together with Reserve() this controls when the pools reallocate.
+	 */
+	template<typename... Component>
+	void ShrinkToFit();
+
 	//////////////////////////////////////////////////
 	/**
 	 * @brief Creates a new entity and returns it.
@@ -89,6 +122,30 @@ public:
 	 */
 	[[nodiscard]] struct FEntity Create(FEntity Hint);
 
+	/** Creates one entity per element of the given array at once and writes them into it */
+	void Create(TArrayView<entt::entity> OutEntities);
+
+	//////////////////////////////////////////////////
+	/**
+	 * Does the entity still exist? Compares the version stored in the id with the current version of the entity, so ids of destroyed
+	 * entities are invalid even when their index was recycled.
+	 */
+	[[nodiscard]] bool IsValid(struct FEntityId Entity) const;
+
+	/**
+	 * Checks a batch of ids, e.g. the references stored in components, in one pass.
+	 * @param Entities		The ids to check
+	 * @param OutValid		Set to one bit per id, true when the entity still exists
+	 * @return The number of invalid ids
+	 */
+	int32 ValidateHandles(TArrayView<const struct FEntityId> Entities, TBitArray<>& OutValid) const;
+
+	/**
+	 * Sets all ids of destroyed entities to null.
+	 * @return The number of ids that were cleared
+	 */
+	int32 ClearStaleHandles(TArrayView<struct FEntityId> Entities) const;
+
 	//////////////////////////////////////////////////
 	/**
 	 * @brief Destroys an entity.
@@ -96,12 +153,19 @@ public:
 	 * When an entity is destroyed, its version is updated and the identifier
 	 * can be recycled at any time.
 	 *
+	 * @note
+	 * Links of FRelationship components that reference the entity are not
+	 * updated. Use ECS::Hierarchy::DestroySubtrees for entities in a hierarchy.
+	 *
 	 * @sa remove_all
 	 *
 	 * @param Entity A valid entity identifier.
 	 */
 	void Destroy(FEntity Entity);
 
+	/** Destroys all given entities at once. Same as Destroy(FEntity) for each of them */
+	void Destroy(TArrayView<const entt::entity> Entities);
+
 	//////////////////////////////////////////////////
 	/**
 	 * @brief Returns a view for the given components.
@@ -138,6 +202,7 @@ public:
 	template<typename... Component, typename... Exclude>
 	[[nodiscard]] TECSView<TECSExclude<Exclude...>, Component...> View(TECSExclude<Exclude...> = {}) const
 	{
+		ECS_RECORD_ACCESS(Component..., const Exclude...);
 		return Registry.view<Component...>(TECSExclude<Exclude...>());
 	}
 
@@ -145,6 +210,7 @@ public:
 	template<typename... Component, typename... Exclude>
 	[[nodiscard]] TECSView<TECSExclude<Exclude...>, Component...> View(TECSExclude<Exclude...> Excludes = {})
 	{
+		ECS_RECORD_ACCESS(Component..., const Exclude...);
 		return Registry.view<Component...>(TECSExclude<Exclude...>());
 	}
 
@@ -169,7 +235,12 @@ public:
 	 * @note
 	 * Pools of components that are owned by a group cannot be sorted anymore.
 	 * The group takes the ownership of the pools and arrange components so as
-	 * to iterate them as fast as possible.
+	 * to iterate them as fast as possible.<br/>
+	 * A pool can only be owned by one group, or by groups that are nested
+	 * (one owns a superset of the other). Conflicting groups assert. The
+	 * plugin itself owns the pools of its core groups (@see ReserveGroup and
+	 * UECSRegistry::Initialize), so e.g. FTransform can only be owned by groups
+	 * that also own FActorPtrComponent and TECSShared<FSyncTransformToActor>.
 	 *
 	 * @tparam Owned Types of components owned by the group.
 	 * @tparam Get Types of components observed by the group.
@@ -179,6 +250,8 @@ public:
 	template<typename... Owned, typename... Get, typename... Exclude>
 	[[nodiscard]] TECSGroup<TECSExclude<Exclude...>, TECSGet<Get...>, Owned...> Group(TECSGet<Get...>, TECSExclude<Exclude...> = {})
 	{
+		ClaimOwnedPools<Owned...>(nullptr);
+		ECS_RECORD_ACCESS(Owned..., Get..., const Exclude...);
 		return Registry.group<Owned...>(TECSGet<Get...>(), TECSExclude<Exclude...>());
 	}
 
@@ -194,9 +267,258 @@ public:
 	template<typename... Owned, typename... Exclude>
 	[[nodiscard]] TECSGroup<TECSExclude<Exclude...>, TECSGet<>, Owned...> Group(TECSExclude<Exclude...> = {})
 	{
+		ClaimOwnedPools<Owned...>(nullptr);
+		ECS_RECORD_ACCESS(Owned..., const Exclude...);
 		return Registry.group<Owned...>(TECSExclude<Exclude...>());
 	}
 
+	/**
+	 * Creates a full-owning group up front and claims its pools under the given name.
+	 * Use this at initialization for groups that should always exist, so that conflicting groups created later on are reported
+	 * with the name of the group that already owns the pools.
+	 *
+	 * @tparam Owned Types of components owned by the group.
+	 * @param Name Name of the group, used when reporting conflicts.
+	 */
+	template<typename... Owned>
+	void ReserveGroup(const TCHAR* Name)
+	{
+		static_assert(sizeof...(Owned) > 1, "A group has to own at least two pools");
+		ClaimOwnedPools<Owned...>(Name);
+		(void)Registry.group<Owned...>();
+	}
+
+	//////////////////////////////////////////////////
+	/**
+	 * Iterates all entities with the given components, whose tag signature contains all tags of Required and none of Excluded.
+	 * Tags are tested with one AND on the signature instead of probing one pool per tag. Entities without a signature never had a
+	 * tag, they match when nothing is required.
+	 * @see ECS::TagMask
+	 *
+	 * @tparam Component Types of (non empty) components that are passed to the function.
+	 * @param Required Tags that the entities must have.
+	 * @param Excluded Tags that the entities must not have.
+	 * @param Function Called as void(entt::entity, Component&...) for each matching entity.
+	 */
+	template<typename... Component, typename Func>
+	void EachWithTags(uint64 Required, uint64 Excluded, Func Function)
+	{
+		static_assert((!std::is_empty_v<Component> && ...), "Use the tag masks to filter for tags");
+		ECS_RECORD_ACCESS(const FECSTagSignature, Component...);
+		if (Required != 0)
+		{
+			// Only entities with a signature can have the required tags
+			const auto View = Registry.view<const FECSTagSignature, Component...>();
+			ECS_TRACE_QUERY(View);
+			View.each(
+				[&](const entt::entity Entity, const FECSTagSignature& Signature, Component&... Components)
+				{
+					if (Signature.Matches(Required, Excluded))
+					{
+						Function(Entity, Components...);
+					}
+				});
+		}
+		else if constexpr (sizeof...(Component) > 0)
+		{
+			const auto View = Registry.view<Component...>();
+			ECS_TRACE_QUERY(View);
+			View.each(
+				[&](const entt::entity Entity, Component&... Components)
+				{
+					const FECSTagSignature* Signature = Registry.try_get<FECSTagSignature>(Entity);
+					if (!Signature || Signature->Matches(0, Excluded))
+					{
+						Function(Entity, Components...);
+					}
+				});
+		}
+		else
+		{
+			Registry.each(
+				[&](const entt::entity Entity)
+				{
+					const FECSTagSignature* Signature = Registry.try_get<FECSTagSignature>(Entity);
+					if (!Signature || Signature->Matches(0, Excluded))
+					{
+						Function(Entity);
+					}
+				});
+		}
+	}
+
+	/** Removes the given tag from all entities that have it */
+	template<typename Tag>
+	void ClearTag()
+	{
+		const uint64 Bit = ECS::TagBit<Tag>();
+		const auto View = Registry.view<Tag>();
+		ECS_TRACE_QUERY(View);
+		for (const entt::entity Entity : View)
+		{
+			// Tags added through the EnTT registry have no signature
+			if (FECSTagSignature* Signature = Registry.try_get<FECSTagSignature>(Entity))
+			{
+				Signature->Mask &= ~Bit;
+			}
+		}
+		Registry.clear<Tag>();
+	}
+
+	//////////////////////////////////////////////////
+	/**
+	 * Enables or disables the entity. Disabled entities keep all their components, but are skipped by EachEnabled(),
+	 * EachEnabledRange() and TECSCachedQuery::EachEnabled(). Plain iterations of views, groups and cached queries still visit them.
+	 * O(1), no pool is changed and no signal is fired.
+	 */
+	void SetEnabled(entt::entity Entity, bool bEnabled)
+	{
+		if (bEnabled)
+		{
+			DisabledEntities.Remove(Entity);
+		}
+		else
+		{
+			DisabledEntities.Add(Entity);
+		}
+	}
+
+	bool IsEnabled(entt::entity Entity) const
+	{
+		return !DisabledEntities.Contains(Entity);
+	}
+
+	/**
+	 * Enables or disables one component of the entity. The entity is skipped by EachEnabled() for queries that contain the component.
+	 * O(1), no pool is changed and no signal is fired.
+	 */
+	template<typename Component>
+	void SetComponentEnabled(entt::entity Entity, bool bEnabled)
+	{
+		SetComponentEnabled(ECS::TypeId<Component>(), Entity, bEnabled);
+	}
+
+	template<typename Component>
+	bool IsComponentEnabled(entt::entity Entity) const
+	{
+		return IsComponentEnabled(ECS::TypeId<Component>(), Entity);
+	}
+
+	/** Type erased versions of the above, for the component type with the given id (@see ECS::TypeId) */
+	void SetComponentEnabled(entt::id_type Type, entt::entity Entity, bool bEnabled)
+	{
+		TUniquePtr<FECSDisabledSet>& Disabled = DisabledComponents.FindOrAdd(Type);
+		if (!Disabled.IsValid())
+		{
+			Disabled = MakeUnique<FECSDisabledSet>();
+		}
+		if (bEnabled)
+		{
+			Disabled->Remove(Entity);
+		}
+		else
+		{
+			Disabled->Add(Entity);
+		}
+	}
+
+	bool IsComponentEnabled(entt::id_type Type, entt::entity Entity) const
+	{
+		const TUniquePtr<FECSDisabledSet>* Disabled = DisabledComponents.Find(Type);
+		return !Disabled || !(*Disabled)->Contains(Entity);
+	}
+
+	/**
+	 * Returns the set of disabled entities and the sets of the given disabled components, without the empty ones. Lets other
+	 * iterations skip disabled entities like EachEnabled(), an entity is enabled when none of the sets contains it.
+	 */
+	template<typename... Component>
+	TArray<const FECSDisabledSet*, TInlineAllocator<8>> GetDisabledSets() const
+	{
+		TArray<const FECSDisabledSet*, TInlineAllocator<8>> Disabled = { &DisabledEntities, FindDisabledComponents<Component>()... };
+		Disabled.RemoveAllSwap([](const FECSDisabledSet* Set) { return !Set || Set->IsEmpty(); }, false);
+		return Disabled;
+	}
+
+	/**
+	 * Iterates a view or group like Query.each(), but skips disabled entities and entities with a disabled component of the query.
+	 * When nothing is disabled, this is a plain iteration. Otherwise it costs one load and compare per entity and disabled component type.
+	 *
+	 * @code{.cpp}
+	 * Registry->EachEnabled(Registry->View<FECSPosition, const FECSVelocity>(), [](entt::entity Entity, FECSPosition& Position, const FECSVelocity& Velocity) {});
+	 * @endcode
+	 *
+	 * @param Query		A view or group
+	 * @param Function	Called as void(entt::entity, Component&...) with the non empty components of the query
+	 */
+	template<typename Query, typename Func>
+	void EachEnabled(const Query& InQuery, Func Function) const
+	{
+		ECS_TRACE_QUERY(InQuery);
+
+		TArray<const FECSDisabledSet*, TInlineAllocator<8>> Disabled = FindDisabledComponents(InQuery);
+		Disabled.RemoveAllSwap([](const FECSDisabledSet* Set) { return !Set || Set->IsEmpty(); }, false);
+
+		if (DisabledEntities.IsEmpty() && Disabled.Num() == 0)
+		{
+			for (auto&& Tuple : InQuery.each())
+			{
+				std::apply(Function, Tuple);
+			}
+			return;
+		}
+
+		for (auto&& Tuple : InQuery.each())
+		{
+			const entt::entity Entity = std::get<0>(Tuple);
+			if (!DisabledEntities.Contains(Entity)
+				&& !Disabled.ContainsByPredicate([Entity](const FECSDisabledSet* Set) { return Set->Contains(Entity); }))
+			{
+				std::apply(Function, Tuple);
+			}
+		}
+	}
+
+	/**
+	 * Calls void(int32 Begin, int32 End) for each run of consecutive enabled entities of a group or single component view, as index
+	 * range into its packed arrays (Query.data(), Query.raw()). Lets batch kernels skip disabled entities and keep their packed loops.
+	 * When nothing is disabled, the function is called once with the whole range.
+	 */
+	template<typename Query, typename Func>
+	void EachEnabledRange(const Query& InQuery, Func Function) const
+	{
+		ECS_TRACE_QUERY(InQuery);
+
+		const int32 Num = static_cast<int32>(InQuery.size());
+		TArray<const FECSDisabledSet*, TInlineAllocator<8>> Disabled = FindDisabledComponents(InQuery);
+		Disabled.RemoveAllSwap([](const FECSDisabledSet* Set) { return !Set || Set->IsEmpty(); }, false);
+
+		if (DisabledEntities.IsEmpty() && Disabled.Num() == 0)
+		{
+			if (Num > 0)
+			{
+				Function(0, Num);
+			}
+			return;
+		}
+
+		const entt::entity* Entities = InQuery.data();
+		int32 Begin = 0;
+		for (int32 Index = 0; Index <= Num; ++Index)
+		{
+			const bool bEnd = Index == Num || DisabledEntities.Contains(Entities[Index])
+				|| Disabled.ContainsByPredicate([Entity = Entities[Index]](const FECSDisabledSet* Set) { return Set->Contains(Entity); });
+			if (bEnd)
+			{
+				if (Index > Begin)
+				{
+					Function(Begin, Index);
+				}
+				Begin = Index + 1;
+			}
+		}
+	}
+
 	//////////////////////////////////////////////////
 	/**
      * @brief Returns a sink object for the given component.
@@ -211,7 +533,9 @@ public:
 	* @endcode
     *
     * Listeners are invoked **after** the component has been assigned to the
-    * entity.
+    * entity.<br/>
+    * Listeners run inside the loop of whoever adds the component, once per
+    * entity. Use BatchedEvents() to get the events once per frame instead.
     *
     * @sa sink
     *
@@ -274,6 +598,63 @@ public:
 		return Registry.on_destroy<Component>();
 	}
 
+	/**
+	 * Returns the batched events of the given component. They are created on the first call.
+	 * Instead of calling listeners for every single entity, the events are collected and delivered once per frame, when
+	 * FlushBatchedEvents() is called. For the game instance registry this happens after all actors and systems ticked.
+	 * @see TECSBatchedEvents
+	 */
+	template<typename Component>
+	[[nodiscard]] TECSBatchedEvents<Component>& BatchedEvents()
+	{
+		TUniquePtr<FECSBatchedEventsBase>& Events = EventBatches.FindOrAdd(ECS::TypeId<Component>());
+		if (!Events.IsValid())
+		{
+			Events = MakeUnique<TECSBatchedEvents<Component>>(Registry);
+			Stats.TrackBacklog(Events.Get(), TEXT("Batched events: ") + ECS::TypeName<Component>(),
+							   [Batch = Events.Get()]() { return Batch->GetNumPending(); });
+		}
+		return static_cast<TECSBatchedEvents<Component>&>(*Events);
+	}
+
+	/** Delivers the batched events of all components */
+	void FlushBatchedEvents();
+
+	/**
+	 * Returns the store of the shared values of type T. It is created on the first call.
+	 * @see TECSSharedStore
+	 */
+	template<typename T>
+	[[nodiscard]] TECSSharedStore<T>& Shared()
+	{
+		TUniquePtr<FECSSharedStoreBase>& Store = SharedStores.FindOrAdd(ECS::TypeId<T>());
+		if (!Store.IsValid())
+		{
+			Store = MakeUnique<TECSSharedStore<T>>(Registry);
+		}
+		return static_cast<TECSSharedStore<T>&>(*Store);
+	}
+
+	/**
+	 * Returns the snapshot of the given components. It is created on the first call and published with PublishSnapshots(), for
+	 * the game instance registry at the end of each frame.
+	 * The snapshot can be passed to and read from other threads, and it stays readable after the registry is destroyed.
+	 * @see TECSSnapshot
+	 */
+	template<typename... Component>
+	[[nodiscard]] TSharedRef<TECSSnapshot<Component...>, ESPMode::ThreadSafe> Snapshot()
+	{
+		TSharedPtr<FECSSnapshotBase, ESPMode::ThreadSafe>& Snapshot = Snapshots.FindOrAdd(ECS::TypeId<TECSSnapshot<Component...>>());
+		if (!Snapshot.IsValid())
+		{
+			Snapshot = MakeShared<TECSSnapshot<Component...>, ESPMode::ThreadSafe>();
+		}
+		return StaticCastSharedPtr<TECSSnapshot<Component...>>(Snapshot).ToSharedRef();
+	}
+
+	/** Copies the pools of all snapshots and publishes them. Game thread only */
+	void PublishSnapshots(uint64 FrameNumber);
+
 	
 	//////////////////////////////////////////////////
 	const entt::registry& GetEntTTReg() const
@@ -286,8 +667,110 @@ public:
 		return Registry;
 	}
 
+	/** Returns the runtime statistics of this registry */
+	FECSStats& GetStats()
+	{
+		return Stats;
+	}
+
+	/**
+	 * Disconnects all observers from this registry, e.g. before it is torn down. Observers may outlive the registry (e.g. in systems
+	 * that are deinitialized after it), they are left disconnected and don't touch it anymore.
+	 */
+	void DisconnectObservers();
+
+	/** Returns the recorder that currently records this registry or nullptr */
+	class FECSReplayRecorder* GetRecorder() const
+	{
+		return Recorder;
+	}
+
 private:
+	/** Frees the slots of a destroyed entity in the disabled sets, so they don't keep EachEnabled() off its fast path */
+	void ClearDisabled(entt::entity Entity);
+
+	template<typename Component>
+	const FECSDisabledSet* FindDisabledComponents() const
+	{
+		const TUniquePtr<FECSDisabledSet>* Disabled = DisabledComponents.Find(ECS::TypeId<Component>());
+		return Disabled ? Disabled->Get() : nullptr;
+	}
+
+	template<typename... Exclude, typename... Component>
+	TArray<const FECSDisabledSet*, TInlineAllocator<8>> FindDisabledComponents(const TECSView<TECSExclude<Exclude...>, Component...>&) const
+	{
+		return { FindDisabledComponents<Component>()... };
+	}
+
+	template<typename... Exclude, typename... Get, typename... Owned>
+	TArray<const FECSDisabledSet*, TInlineAllocator<8>> FindDisabledComponents(const TECSGroup<TECSExclude<Exclude...>, TECSGet<Get...>, Owned...>&) const
+	{
+		return { FindDisabledComponents<Owned>()..., FindDisabledComponents<Get>()... };
+	}
+
+	template<typename... Owned>
+	void ClaimOwnedPools(const TCHAR* Name)
+	{
+#if !UE_BUILD_SHIPPING
+		if constexpr (sizeof...(Owned) > 0)
+		{
+			// Checked once per pack of owned types, the group itself is cached by EnTT after the first call
+			bool bAlreadyClaimed = false;
+			ClaimedPacks.Add(ECS::TypeId<entt::type_list<Owned...>>(), &bAlreadyClaimed);
+			if (bAlreadyClaimed)
+			{
+				return;
+			}
+			static const FString TypeNames = FString::Join(TArray<FString>{ ECS::TypeName<Owned>()... }, TEXT(", "));
+			ClaimOwnedPools({ ECS::TypeId<Owned>()... }, Name ? Name : *TypeNames);
+		}
+#endif
+	}
+
+	/** Registers the owned pools of a group. Asserts when the pools are already owned by another, not nested, group */
+	void ClaimOwnedPools(std::initializer_list<entt::id_type> Types, const TCHAR* Name);
+
+	struct FOwnedPools
+	{
+		TArray<entt::id_type, TInlineAllocator<8>> Types;
+		FString Name;
+	};
+	
 	entt::registry Registry;
+
+	/* Declared after Registry, so it disconnects from the pools before the registry is destroyed */
+	FECSStats Stats;
+
+	/* Batched events per component type. Declared after Registry, so they disconnect before the registry is destroyed */
+	TMap<entt::id_type, TUniquePtr<FECSBatchedEventsBase>> EventBatches;
+
+	/* Shared value stores per value type. Declared after Registry, so they disconnect before the registry is destroyed */
+	TMap<entt::id_type, TUniquePtr<FECSSharedStoreBase>> SharedStores;
+
+	/* Double buffered copies of pools, readable from other threads */
+	TMap<entt::id_type, TSharedPtr<FECSSnapshotBase, ESPMode::ThreadSafe>> Snapshots;
+
+	/* Pools owned by the groups of this registry */
+	TArray<FOwnedPools> OwnedPools;
+
+	/* Packs of owned types for which ClaimOwnedPools() already ran */
+	TSet<entt::id_type> ClaimedPacks;
+
+	/* Disabled entities and per component type the entities whose component is disabled. Pointers, so they stay put while iterating */
+	FECSDisabledSet DisabledEntities;
+	TMap<entt::id_type, TUniquePtr<FECSDisabledSet>> DisabledComponents;
+
+	/* Set while a recorder is attached. Owned by whoever started the recording */
+	class FECSReplayRecorder* Recorder = nullptr;
+	friend class FECSReplayRecorder;
+
+	/* Open replay player, if any. Closed when the registry deinitializes */
+	class FECSReplayPlayer* Player = nullptr;
+	friend class FECSReplayPlayer;
+
+	/* Connected observers, @see DisconnectObservers */
+	TArray<class FECSObserver*> Observers;
+	friend class FECSObserver;
 };
 
 //////////////////////////////////////////////////
@@ -309,6 +792,25 @@ bool IECSRegistryInterface::Empty() const
 	return Registry.empty<Component...>();
 }
 
+//////////////////////////////////////////////////
+template <typename ... Component>
+void IECSRegistryInterface::Reserve(int32 Capacity)
+{
+	Registry.reserve<Component...>(Capacity);
+}
+
+template <typename Component>
+int32 IECSRegistryInterface::Capacity() const
+{
+	return Registry.capacity<Component>();
+}
+
+template <typename ... Component>
+void IECSRegistryInterface::ShrinkToFit()
+{
+	Registry.shrink_to_fit<Component...>();
+}
+
 //////////////////////////////////////////////////
 //////////////////////////////////////////////////
 /**
@@ -326,9 +828,43 @@ public:
 
 	/** Return a reference to the game instance registry. This is safe to call after the game instance has been initialized */
 	static UECSRegistry& GetRegistry();
+
+	/** Is there a game instance registry? */
+	static bool HasRegistry();
+
+	/** Queues the wrapper to be registered with the next call to FlushRegistrations() */
+	void EnqueueRegistration(class UECSComponentWrapper* Wrapper);
+
+	/**
+	 * Registers all queued wrappers. Creates one entity per actor in one batch and then registers the wrappers grouped by class, so
+	 * the components of one type are added after each other, with the pools reserved up front.
+	 * Called at the start of each world tick.
+	 */
+	void FlushRegistrations();
+
+	/**
+	 * Registers a queued wrapper right away, together with the other queued wrappers of its actor. Used when the entity of the
+	 * wrapper is needed before the next FlushRegistrations(). Does nothing if the wrapper isn't queued.
+	 */
+	void RegisterImmediately(class UECSComponentWrapper* Wrapper);
 	
 private:
+	/** Creates one entity per actor for the wrappers and registers them grouped by class */
+	void RegisterWrappers(TArray<class UECSComponentWrapper*>& Wrappers);
+
+
+	/** Start of each world tick */
+	void OnWorldTickStart(UWorld* World, ELevelTick TickType, float DeltaTime);
+	
+	/** Sync point at the end of each world tick */
+	void OnWorldPostActorTick(UWorld* World, ELevelTick TickType, float DeltaTime);
+	
 	static UECSRegistry* RegistryPtr;
+
+	FDelegateHandle PostActorTickHandle;
+	FDelegateHandle TickStartHandle;
+
+	TArray<TWeakObjectPtr<class UECSComponentWrapper>> PendingRegistrations;
 };
 
 
@@ -347,14 +883,37 @@ namespace ECS
 class FECSObserver
 {
 public:
+	~FECSObserver()
+	{
+		Disconnect();
+	}
+	
+	/**
+	 * Connects the observer to the registry.
+	 * @param Name Name under which the backlog of the observer shows up in the registry's stats
+	 */
 	template<typename... Matcher>
-	void Connect(IECSRegistryInterface& Registry, const FECSCollector<Matcher...>& Collector)
+	void Connect(IECSRegistryInterface& Registry, const FECSCollector<Matcher...>& Collector, const FString& Name = TEXT("Observer"))
 	{
+		Disconnect();
 		Observer.connect(Registry.GetEntTTReg(), Collector);
+		ConnectedRegistry = &Registry;
+		Registry.Observers.Add(this);
+#if ECS_WITH_QUERY_TRACE
+		TraceName.SetName(TEXT("ECS Observer: ") + Name);
+#endif
+		Registry.GetStats().TrackBacklog(this, Name, [this]() { return Size(); });
 	}
 
+	/** Disconnects from the registry. Does nothing if the registry already disconnected us */
 	void Disconnect();
 
+	/** Returns the number of entities waiting to be processed */
+	int32 Size() const
+	{
+		return static_cast<int32>(Observer.size());
+	}
+
 	template<typename Func>
 	void Each(Func Function);
 	
@@ -363,17 +922,24 @@ public:
 
 private:
 	entt::observer Observer;
+	IECSRegistryInterface* ConnectedRegistry = nullptr;
+
+#if ECS_WITH_QUERY_TRACE
+	ECS::Trace::FScopeName TraceName;
+#endif
 };
 
 //////////////////////////////////////////////////
 template <typename Func>
 void FECSObserver::Each(Func Function)
 {
+	ECS_TRACE_SCOPE(TraceName, Size());
 	Observer.each(Function);
 }
 
 template <typename Func>
 void FECSObserver::Each(Func Function) const
 {
+	ECS_TRACE_SCOPE(TraceName, Size());
 	Observer.each(Function);
 }
@@ -0,0 +1,176 @@
+// Copyright @Paul Larrass 2020
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Tickable.h"
+#include "Serialization/MemoryWriter.h"
+#include "ECSComponentTypes.h"
+
+
+//////////////////////////////////////////////////
+/** Record types of a replay file. Each record starts with one of these bytes */
+enum class EECSReplayRecord : uint8
+{
+	/* End of a frame. Followed by the delta time as float */
+	Frame,
+
+	/* First use of a component type. Followed by the type index as uint16 and the registered name as FString */
+	Type,
+
+	/* Followed by the entity as uint32 */
+	Create,
+	Destroy,
+
+	/* Followed by the entity as uint32, the type index as uint16, the size of the value as uint32 and the value */
+	Emplace,
+	Patch,
+
+	/* Followed by the entity as uint32 and the type index as uint16 */
+	Remove,
+};
+
+//////////////////////////////////////////////////
+/**
+ * Records the mutations of a registry into a compact binary file, so they can be replayed offline with FECSReplayPlayer.
+ *
+ * Recorded are:
+ * - A keyframe with all existing entities and their recorded components when the recording starts
+ * - Entities created and destroyed through IECSRegistryInterface::Create() and Destroy(). Entities created directly in the EnTT
+ *   registry are created on their first use when replaying
+ * - Components of all types registered in FECSComponentTypes, when they are added, patched or replaced and removed. Changes made
+ *   through references (e.g. GetComponent()) are not signaled and therefore not recorded, use FEntity::PatchComponent() for those
+ *
+ * Records are collected in memory and written to the file once per frame, with EndFrame(). The game instance registry calls it
+ * after all actors and systems ticked. Nothing is connected to the registry while no recording is running.
+ *
+ * Console commands (for the game instance registry):
+ * - ecs.Replay.Record		Starts recording to Saved/Profiling/ECSReplay-<date>.ecsreplay. Optional argument: File path
+ * - ecs.Replay.Stop		Stops the recording and the playback
+ * - ecs.Replay.Play <File>	Replays the file into the game instance registry, one recorded frame per tick
+ */
+class UNREALENGINEECS_API FECSReplayRecorder : private IECSComponentListener
+{
+public:
+	explicit FECSReplayRecorder(IECSRegistryInterface& Registry);
+	virtual ~FECSReplayRecorder();
+
+	FECSReplayRecorder(const FECSReplayRecorder&) = delete;
+	FECSReplayRecorder& operator=(const FECSReplayRecorder&) = delete;
+
+	/** Creates the file and attaches to the registry. Only one recorder can be attached to a registry */
+	bool Start(const FString& FilePath);
+
+	/** Closes the file and detaches from the registry. Records of the unfinished frame are dropped */
+	void Stop();
+
+	bool IsRecording() const
+	{
+		return File.IsValid();
+	}
+
+	/** Ends the current frame and writes its records to the file */
+	void EndFrame(float DeltaTime);
+
+	void RecordCreate(entt::entity Entity);
+	void RecordDestroy(entt::entity Entity);
+
+	/** Magic number and version at the start of each file */
+	static constexpr uint32 FileMagic = 0x52534345;
+	static constexpr uint32 FileVersion = 1;
+
+private:
+	//~ Begin IECSComponentListener Interface
+	virtual void OnComponentConstructed(entt::id_type Type, entt::registry& Registry, entt::entity Entity) override;
+	virtual void OnComponentUpdated(entt::id_type Type, entt::registry& Registry, entt::entity Entity) override;
+	virtual void OnComponentDestroyed(entt::id_type Type, entt::registry& Registry, entt::entity Entity) override;
+	//~ End IECSComponentListener Interface
+
+	void RecordValue(EECSReplayRecord Record, entt::id_type Type, entt::entity Entity);
+
+	/** Records the creation of all existing entities and the values of their recorded components */
+	void WriteKeyframe();
+
+	/** Returns the index of the type in this file. Writes the type record on first use */
+	uint16 GetTypeIndex(const FECSComponentType& Type);
+
+	IECSRegistryInterface& Registry;
+
+	/* Connected component types */
+	TArray<const FECSComponentType*> Types;
+
+	/* Index of each type in the file */
+	TMap<entt::id_type, uint16> TypeIndices;
+
+	TUniquePtr<FArchive> File;
+
+	/* Records of the current frame */
+	TArray<uint8> FrameBuffer;
+	FMemoryWriter FrameWriter;
+
+	/* Scratch buffer for component values */
+	TArray<uint8> ValueBuffer;
+};
+
+//////////////////////////////////////////////////
+/**
+ * Replays a file written by FECSReplayRecorder into a registry, frame by frame.
+ * Recorded entities are mapped to new entities of the target registry. Component types that aren't registered in
+ * FECSComponentTypes (or have no default constructor) are skipped.
+ * Only one player can be open per registry. It's closed when the game instance registry deinitializes.
+ */
+class UNREALENGINEECS_API FECSReplayPlayer : public FTickableGameObject
+{
+public:
+	explicit FECSReplayPlayer(IECSRegistryInterface& Registry);
+	virtual ~FECSReplayPlayer();
+
+	/**
+	 * Opens the file.
+	 * @param bTickAutomatically When true, one recorded frame is replayed each tick until the file is done
+	 */
+	bool Open(const FString& FilePath, bool bTickAutomatically = true);
+
+	void Close();
+
+	/**
+	 * Applies the records of the next frame.
+	 * @return False when the file is done
+	 */
+	bool StepFrame();
+
+	/** Returns the number of frames that were replayed */
+	int32 GetNumFrames() const { return NumFrames; }
+
+	/** Returns the recorded delta time of the last replayed frame */
+	float GetFrameDeltaTime() const { return FrameDeltaTime; }
+
+	/** Called once after the last frame was replayed */
+	FSimpleMulticastDelegate OnFinished;
+
+	//~ Begin FTickableGameObject Interface
+	virtual void Tick(float DeltaTime) override;
+	virtual bool IsTickable() const override;
+	virtual TStatId GetStatId() const override;
+	//~ End FTickableGameObject Interface
+
+private:
+	/** Returns the target entity of a recorded entity, creates it on first use */
+	entt::entity MapEntity(uint32 Recorded);
+
+	IECSRegistryInterface& Registry;
+
+	TUniquePtr<FArchive> File;
+
+	/* Component type of each type index in the file, nullptr if it's unknown */
+	TArray<const FECSComponentType*> Types;
+
+	/* Recorded entity -> entity in the target registry */
+	TMap<uint32, entt::entity> Entities;
+
+	TArray<uint8> ValueBuffer;
+
+	bool bTickAutomatically = false;
+	int32 NumFrames = 0;
+	float FrameDeltaTime = 0.f;
+};
@@ -0,0 +1,190 @@
+// Copyright @Paul Larrass 2020
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "ECSIncludes.h"
+
+
+template<typename T>
+class TECSSharedStore;
+
+//////////////////////////////////////////////////
+/** Component that references a shared value of type T. Only the store of the registry creates and changes it. @see TECSSharedStore */
+template<typename T>
+struct TECSShared
+{
+	/** Returns the index of the value in the store of the registry */
+	int32 GetIndex() const
+	{
+		return Index;
+	}
+
+private:
+	friend class TECSSharedStore<T>;
+
+	explicit TECSShared(const int32 InIndex)
+		: Index(InIndex)
+	{
+	}
+
+	/* Index of the value in the store of the registry */
+	int32 Index = INDEX_NONE;
+};
+
+//////////////////////////////////////////////////
+/** Base class of the shared value stores, so the registry can own them without knowing their type */
+class UNREALENGINEECS_API FECSSharedStoreBase
+{
+public:
+	virtual ~FECSSharedStoreBase() = default;
+
+	/** Returns the number of distinct values */
+	virtual int32 GetNumValues() const = 0;
+};
+
+//////////////////////////////////////////////////
+/**
+ * Deduplicated values of type T, shared by many entities.
+ *
+ * Entities don't store the value, but a TECSShared<T> with the index of the value. Entities that are set to equal values share one
+ * entry, so the value exists once instead of once per entity. The store also keeps the entities of each value in a packed array,
+ * so code can be run once per distinct value over all of its entities (@see EachBatch), loading the value once per batch.
+ * A value is freed when its last entity is set to another value, loses its TECSShared<T> or is destroyed.
+ *
+ * T needs operator== and GetTypeHash(). Shared values are immutable, set the entity to a new value to change it.
+ *
+ * @see IECSRegistryInterface::Shared
+ */
+template<typename T>
+class TECSSharedStore : public FECSSharedStoreBase
+{
+public:
+	explicit TECSSharedStore(entt::registry& InRegistry)
+		: Registry(InRegistry)
+	{
+		Registry.on_destroy<TECSShared<T>>().template connect<&TECSSharedStore::HandleDestroy>(*this);
+	}
+
+	virtual ~TECSSharedStore()
+	{
+		Registry.on_destroy<TECSShared<T>>().disconnect(*this);
+	}
+
+	TECSSharedStore(const TECSSharedStore&) = delete;
+	TECSSharedStore& operator=(const TECSSharedStore&) = delete;
+
+	/** Sets the shared value of the entity. Adds the TECSShared<T> if the entity doesn't have one yet */
+	void Set(const entt::entity Entity, const T& Value)
+	{
+		const int32 Index = FindOrAdd(Value);
+		if (TECSShared<T>* Shared = Registry.try_get<TECSShared<T>>(Entity))
+		{
+			if (Shared->Index == Index && IsMember(Index, Entity))
+			{
+				return;
+			}
+
+			// Changing the index in place doesn't move anything in the pool. It's patched, so listeners like the replay see the new value
+			Release(Shared->Index, Entity);
+			Registry.patch<TECSShared<T>>(Entity, [Index](TECSShared<T>& Changed) { Changed.Index = Index; });
+		}
+		else
+		{
+			Registry.emplace<TECSShared<T>>(Entity, TECSShared<T>(Index));
+		}
+		Entries[Index]->Members.emplace(Entity);
+	}
+
+	/** Returns the value with the given index, e.g. from a TECSShared<T> */
+	const T& Get(const int32 Index) const
+	{
+		return Entries[Index]->Value;
+	}
+
+	/** Returns the shared value of the entity. Asserts when it has none */
+	const T& GetForEntity(const entt::entity Entity) const
+	{
+		return Get(Registry.get<TECSShared<T>>(Entity).Index);
+	}
+
+	/**
+	 * Calls the function once per distinct value as void(const T& Value, TArrayView<const entt::entity> Entities), with all entities
+	 * that share the value. Entities must not change their value during the iteration.
+	 */
+	template<typename Func>
+	void EachBatch(Func Function) const
+	{
+		for (const TUniquePtr<FEntry>& Entry : Entries)
+		{
+			if (Entry.IsValid())
+			{
+				Function(Entry->Value, TArrayView<const entt::entity>(Entry->Members.data(), Entry->Members.size()));
+			}
+		}
+	}
+
+	virtual int32 GetNumValues() const override
+	{
+		return Lookup.Num();
+	}
+
+private:
+	struct FEntry
+	{
+		T Value;
+
+		/* Entities that share the value */
+		entt::sparse_set Members;
+	};
+
+	int32 FindOrAdd(const T& Value)
+	{
+		if (const int32* Index = Lookup.Find(Value))
+		{
+			return *Index;
+		}
+
+		const int32 Index = FreeIndices.Num() > 0 ? FreeIndices.Pop(false) : Entries.AddDefaulted();
+		Entries[Index] = MakeUnique<FEntry>(FEntry{ Value, {} });
+		Lookup.Add(Value, Index);
+		return Index;
+	}
+
+	/** Copies of the component that weren't made by Set(), e.g. from another registry, aren't members of any value */
+	bool IsMember(const int32 Index, const entt::entity Entity) const
+	{
+		return Entries.IsValidIndex(Index) && Entries[Index].IsValid() && Entries[Index]->Members.contains(Entity);
+	}
+
+	void Release(const int32 Index, const entt::entity Entity)
+	{
+		if (!IsMember(Index, Entity))
+		{
+			return;
+		}
+
+		FEntry& Entry = *Entries[Index];
+		Entry.Members.remove(Entity);
+		if (Entry.Members.size() == 0)
+		{
+			Lookup.Remove(Entry.Value);
+			Entries[Index].Reset();
+			FreeIndices.Add(Index);
+		}
+	}
+
+	void HandleDestroy(entt::registry&, const entt::entity Entity)
+	{
+		Release(Registry.get<TECSShared<T>>(Entity).Index, Entity);
+	}
+
+	entt::registry& Registry;
+
+	/* Values by index. Freed slots are nullptr until they are reused */
+	TArray<TUniquePtr<FEntry>> Entries;
+	TArray<int32> FreeIndices;
+
+	/* Value -> index, for the deduplication */
+	TMap<T, int32> Lookup;
+};
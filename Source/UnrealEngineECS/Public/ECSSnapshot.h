@@ -0,0 +1,178 @@
+// Copyright @Paul Larrass 2020
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "ECSIncludes.h"
+#include "ECSTrace.h"
+#include <atomic>
+
+
+//////////////////////////////////////////////////
+/** Base class of the snapshots, so the registry can publish them without knowing their component types */
+class UNREALENGINEECS_API FECSSnapshotBase
+{
+public:
+	virtual ~FECSSnapshotBase() = default;
+
+	/** Copies the pools into the back buffer and makes it the front buffer. Game thread only */
+	virtual void Publish(const entt::registry& Registry, uint64 FrameNumber) = 0;
+
+	/** Returns the number of frames that weren't published, because a reader still used the back buffer */
+	int32 GetNumSkippedFrames() const
+	{
+		return NumSkippedFrames;
+	}
+
+protected:
+	int32 NumSkippedFrames = 0;
+};
+
+//////////////////////////////////////////////////
+/**
+ * Double buffered, read-only copy of all entities with the given components.
+ *
+ * The game thread copies the components into the back buffer at the end of the frame and publishes it by swapping the buffer
+ * index. Other threads (audio, render proxies, analytics...) read the front buffer without locks and always see one consistent frame.
+ * If a reader still holds the back buffer when the next frame is published, that frame is skipped instead of stalling the game
+ * thread, so keep the read scopes short.
+ *
+ * Components are copied, so they should be small and trivially copyable.
+ *
+ * @code{.cpp}
+ * // Game thread, once
+ * TSharedRef<TECSSnapshot<FECSPosition>, ESPMode::ThreadSafe> Emitters = Registry.Snapshot<FECSPosition>();
+ *
+ * // Any thread
+ * TECSSnapshot<FECSPosition>::FReadScope Read(*Emitters);
+ * Read.Each([](entt::entity Entity, const FECSPosition& Position) {});
+ * @endcode
+ *
+ * @see IECSRegistryInterface::Snapshot
+ */
+template<typename... Component>
+class TECSSnapshot : public FECSSnapshotBase
+{
+	static_assert(sizeof...(Component) > 0, "A snapshot needs at least one component");
+	static_assert((!std::is_empty_v<Component> && ...), "Empty components can't be copied into a snapshot");
+
+	struct FBuffer
+	{
+		TArray<entt::entity> Entities;
+		std::tuple<TArray<Component>...> Components;
+		uint64 FrameNumber = 0;
+
+		/* Number of threads reading this buffer */
+		std::atomic<int32> NumReaders{ 0 };
+	};
+
+public:
+	/**
+	 * Pins the front buffer for reading. The buffer doesn't change while the scope is alive.
+	 * Don't keep it across frames, the game thread skips publishing while it is pinned.
+	 */
+	class FReadScope
+	{
+	public:
+		explicit FReadScope(const TECSSnapshot& Snapshot)
+		{
+			for (;;)
+			{
+				const int32 Index = Snapshot.FrontIndex.load();
+				Buffer = &Snapshot.Buffers[Index];
+				Buffer->NumReaders.fetch_add(1);
+
+				// The game thread may have published in between. It only writes into a buffer without readers and swaps before
+				// checking, so if the index is still the same, the buffer is ours
+				if (Snapshot.FrontIndex.load() == Index)
+				{
+					break;
+				}
+				Buffer->NumReaders.fetch_sub(1);
+			}
+		}
+
+		~FReadScope()
+		{
+			Buffer->NumReaders.fetch_sub(1);
+		}
+
+		FReadScope(const FReadScope&) = delete;
+		FReadScope& operator=(const FReadScope&) = delete;
+
+		/** Returns the number of entities in the snapshot */
+		int32 Num() const
+		{
+			return Buffer->Entities.Num();
+		}
+
+		/** Returns the frame the snapshot was taken in, 0 if nothing was published yet */
+		uint64 GetFrameNumber() const
+		{
+			return Buffer->FrameNumber;
+		}
+
+		TArrayView<const entt::entity> GetEntities() const
+		{
+			return Buffer->Entities;
+		}
+
+		/** Returns the packed components, in the same order as the entities */
+		template<typename Type>
+		TArrayView<const Type> Get() const
+		{
+			return std::get<TArray<Type>>(Buffer->Components);
+		}
+
+		/** Calls the function for each entity as void(entt::entity, const Component&...) */
+		template<typename Func>
+		void Each(Func Function) const
+		{
+			for (int32 Index = 0; Index < Num(); ++Index)
+			{
+				Function(Buffer->Entities[Index], std::get<TArray<Component>>(Buffer->Components)[Index]...);
+			}
+		}
+
+	private:
+		FBuffer* Buffer = nullptr;
+	};
+
+	virtual void Publish(const entt::registry& Registry, const uint64 FrameNumber) override
+	{
+		const int32 BackIndex = 1 - FrontIndex.load();
+		FBuffer& Back = Buffers[BackIndex];
+		if (Back.NumReaders.load() > 0)
+		{
+			++NumSkippedFrames;
+			return;
+		}
+
+		const auto View = Registry.view<const Component...>();
+		ECS_TRACE_QUERY(View);
+		int32 Num;
+		if constexpr (sizeof...(Component) == 1)
+		{
+			Num = static_cast<int32>(View.size());
+		}
+		else
+		{
+			Num = static_cast<int32>(View.size_hint());
+		}
+
+		Back.Entities.Reset(Num);
+		(std::get<TArray<Component>>(Back.Components).Reset(Num), ...);
+		for (const entt::entity Entity : View)
+		{
+			Back.Entities.Add(Entity);
+			(std::get<TArray<Component>>(Back.Components).Add(View.template get<const Component>(Entity)), ...);
+		}
+		Back.FrameNumber = FrameNumber;
+
+		FrontIndex.store(BackIndex);
+	}
+
+private:
+	mutable FBuffer Buffers[2];
+	std::atomic<int32> FrontIndex{ 0 };
+};
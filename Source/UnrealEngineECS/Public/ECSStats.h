@@ -0,0 +1,155 @@
+// Copyright @Paul Larrass 2020
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "ECSIncludes.h"
+
+class UECSSystem;
+class FArchive;
+
+
+//////////////////////////////////////////////////
+struct FECSPoolStats
+{
+	FString Name;
+
+	/* Number of components in the pool */
+	int32 Size = 0;
+
+	float CreatedPerSecond = 0.f;
+	float DestroyedPerSecond = 0.f;
+
+	/* Components created and destroyed per second. The "heat" of the pool */
+	float GetChurn() const { return CreatedPerSecond + DestroyedPerSecond; }
+};
+
+struct FECSBacklogStats
+{
+	FString Name;
+
+	/* Number of entities waiting to be processed */
+	int32 Size = 0;
+};
+
+struct FECSSystemStats
+{
+	FString Name;
+	float EntitiesPerSecond = 0.f;
+	float AverageRunTimeMs = 0.f;
+};
+
+//////////////////////////////////////////////////
+/**
+ * Runtime statistics of a registry: pool sizes and churn, backlogs of observers and batched events and the throughput of systems.
+ * Rates are averaged over one second.
+ *
+ * Console commands (for the game instance registry):
+ * - ecs.Stats				Logs the current statistics
+ * - ecs.Stats.Overlay 1	Shows the pools on screen, sorted and colored by churn, and the backlogs and systems
+ * - ecs.Stats.CsvStart	Starts writing the statistics to Saved/Profiling/ECSStats-<date>.csv every second
+ * - ecs.Stats.CsvStop		Stops writing the CSV file
+ * Entity counts and totals are also available through "stat ECS".
+ */
+class UNREALENGINEECS_API FECSStats
+{
+public:
+	FECSStats() = default;
+	~FECSStats();
+
+	FECSStats(const FECSStats&) = delete;
+	FECSStats& operator=(const FECSStats&) = delete;
+
+	/**
+	 * Tracks the size and churn of the pool of the given component. The game instance registry tracks the pools of all types
+	 * registered in FECSComponentTypes on initialization, call this for other components or types registered later on.
+	 */
+	template<typename Component>
+	void TrackPool(entt::registry& Registry)
+	{
+		const entt::id_type Id = ECS::TypeId<Component>();
+		if (Pools.ContainsByPredicate([Id](const TUniquePtr<FPool>& Pool) { return Pool->Id == Id; }))
+		{
+			return;
+		}
+		
+		FPool& Pool = *Pools.Add_GetRef(MakeUnique<FPool>());
+		Pool.Id = Id;
+		Pool.Stats.Name = ECS::TypeName<Component>();
+		Pool.GetSize = [&Registry]() { return static_cast<int32>(Registry.size<Component>()); };
+		Pool.Disconnect = [&Registry, &Pool]()
+		{
+			Registry.on_construct<Component>().disconnect(Pool);
+			Registry.on_destroy<Component>().disconnect(Pool);
+		};
+		Registry.on_construct<Component>().template connect<&FPool::OnCreated>(Pool);
+		Registry.on_destroy<Component>().template connect<&FPool::OnDestroyed>(Pool);
+	}
+
+	/** Tracks the size of a backlog, e.g. of an observer. Untrack it before the owner is destroyed */
+	void TrackBacklog(const void* Owner, const FString& Name, TFunction<int32()>&& GetSize);
+	void UntrackBacklog(const void* Owner);
+
+	/** Records one run of a system. Called by the system's tick function */
+	void RecordSystemRun(const UECSSystem* System, int32 NumEntities, uint64 Cycles);
+	void RemoveSystem(const UECSSystem* System);
+
+	/** Updates the rates, the stat counters, the overlay and the CSV file. Call once per frame */
+	void Tick(float DeltaTime, const entt::registry& Registry);
+
+	/** Logs the current statistics */
+	void Dump() const;
+
+	bool StartCsv(const FString& FilePath);
+	void StopCsv();
+
+	TArray<FECSPoolStats> GetPoolStats() const;
+
+	/** Returns the name of the tracked pool of the given component type, or an empty string if the pool isn't tracked */
+	FString FindPoolName(entt::id_type Id) const;
+	TArray<FECSBacklogStats> GetBacklogStats() const;
+	TArray<FECSSystemStats> GetSystemStats() const;
+
+private:
+	struct FPool
+	{
+		void OnCreated(entt::registry&, entt::entity) { ++NumCreated; }
+		void OnDestroyed(entt::registry&, entt::entity) { ++NumDestroyed; }
+		
+		entt::id_type Id = 0;
+		FECSPoolStats Stats;
+		uint32 NumCreated = 0;
+		uint32 NumDestroyed = 0;
+		TFunction<int32()> GetSize;
+		TFunction<void()> Disconnect;
+	};
+
+	struct FBacklog
+	{
+		const void* Owner = nullptr;
+		FString Name;
+		TFunction<int32()> GetSize;
+	};
+
+	struct FSystem
+	{
+		FECSSystemStats Stats;
+		int32 NumEntities = 0;
+		int32 NumRuns = 0;
+		uint64 Cycles = 0;
+	};
+
+	void DrawOverlay() const;
+	void WriteCsv();
+
+	/* Pointers, so the addresses stay stable for the signal listeners */
+	TArray<TUniquePtr<FPool>> Pools;
+	TArray<FBacklog> Backlogs;
+	TMap<const UECSSystem*, FSystem> Systems;
+
+	int32 NumEntitiesAlive = 0;
+	float TimeSinceSample = 0.f;
+	double TotalTime = 0.0;
+
+	TUniquePtr<FArchive> CsvFile;
+};
@@ -0,0 +1,52 @@
+// Copyright @Paul Larrass 2020
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "ECSIncludes.h"
+
+
+//////////////////////////////////////////////////
+/**
+ * Tag signature of an entity.
+ * Tags are empty components, which EnTT stores as pure pool membership without any payload. In addition, every tag type gets one bit
+ * in this signature the first time it is used, so views can reject entities with a single AND instead of probing one pool per tag.
+ * Up to 64 tag types are supported.
+ *
+ * The signature is added together with the first tag of an entity. Always use FEntity::AddTag() / RemoveTag(), otherwise the
+ * signature and the tag pools get out of sync.
+ */
+struct UNREALENGINEECS_API FECSTagSignature
+{
+	uint64 Mask = 0;
+
+	/** Do we have all tags of Required and none of Excluded? */
+	bool Matches(uint64 Required, uint64 Excluded = 0) const
+	{
+		return (Mask & Required) == Required && (Mask & Excluded) == 0;
+	}
+
+	/** Returns the bit of the tag with the given type id. A new bit is assigned the first time a tag type is used */
+	static uint64 GetBit(entt::id_type TagTypeId);
+};
+
+
+//////////////////////////////////////////////////
+namespace ECS
+{
+	/** Returns the signature bit of the given tag */
+	template<typename Tag>
+	uint64 TagBit()
+	{
+		static_assert(std::is_empty_v<Tag>, "Tags must be empty types");
+		static const uint64 Bit = FECSTagSignature::GetBit(TypeId<Tag>());
+		return Bit;
+	}
+
+	/** Returns the combined signature bits of the given tags */
+	template<typename... Tag>
+	uint64 TagMask()
+	{
+		return (uint64(0) | ... | TagBit<Tag>());
+	}
+}
@@ -0,0 +1,130 @@
+// Copyright @Paul Larrass 2020
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "ProfilingDebugging/CpuProfilerTrace.h"
+#include "ECSIncludes.h"
+#include <atomic>
+
+/**
+ * Compiles the trace scopes around view, group and observer iterations in. They show up in Unreal Insights when the cpu channel
+ * is enabled. When compiled out, the macros expand to nothing.
+ */
+#ifndef ECS_WITH_QUERY_TRACE
+	#define ECS_WITH_QUERY_TRACE (CPUPROFILERTRACE_ENABLED && !UE_BUILD_SHIPPING)
+#endif
+
+#if ECS_WITH_QUERY_TRACE
+	/** Opens a trace scope named after the components of the view or group and its number of entities, until the end of the block */
+	#define ECS_TRACE_QUERY(Query) ECS_TRACE_SCOPE(ECS::Trace::QueryName(Query), ECS::Trace::QuerySize(Query))
+
+	/**
+	 * Opens a trace scope with the given name (an ECS::Trace::FScopeName) and number of entities, until the end of the block.
+	 * Unlike TRACE_CPUPROFILER_EVENT_SCOPE_TEXT, which announces one event type per call site, the name keeps one per number of entities.
+	 */
+	#define ECS_TRACE_SCOPE(Name, Num) \
+		FCpuProfilerTrace::FEventScope PREPROCESSOR_JOIN(ECSTraceScope, __LINE__)((Name).GetEventId(Num), CpuChannel)
+#else
+	#define ECS_TRACE_QUERY(Query)
+	#define ECS_TRACE_SCOPE(Name, Num)
+#endif
+
+
+#if ECS_WITH_QUERY_TRACE
+namespace ECS::Trace
+{
+	/**
+	 * Name of a trace scope. The number of entities is appended, rounded down to a power of two, so each scope only creates a few
+	 * event types in the trace. The event type of each power of two is announced to the trace the first time it is used.
+	 */
+	class FScopeName
+	{
+	public:
+		FScopeName() = default;
+
+		explicit FScopeName(const FString& InName)
+			: Name(InName)
+		{
+		}
+
+		FScopeName(const FScopeName&) = delete;
+		FScopeName& operator=(const FScopeName&) = delete;
+
+		/** Changes the name. Must not be called while the name is used by a scope */
+		void SetName(const FString& InName)
+		{
+			Name = InName;
+			for (std::atomic<uint32>& EventId : EventIds)
+			{
+				EventId.store(0, std::memory_order_relaxed);
+			}
+		}
+
+		uint32 GetEventId(int32 Num) const
+		{
+			// 0 entities and one bucket per power of two
+			const int32 Bucket = Num > 0 ? FMath::FloorLog2(Num) + 1 : 0;
+			uint32 EventId = EventIds[Bucket].load(std::memory_order_relaxed);
+			if (EventId == 0 && UE_TRACE_CHANNELEXPR_IS_ENABLED(CpuChannel))
+			{
+				// Threads that get here at the same time both announce the type, which is harmless
+				const FString BucketName = FString::Printf(TEXT("%s [%d+]"), *Name, Bucket > 0 ? 1 << (Bucket - 1) : 0);
+				EventId = FCpuProfilerTrace::OutputEventType(*BucketName);
+				EventIds[Bucket].store(EventId, std::memory_order_relaxed);
+			}
+			return EventId;
+		}
+
+	private:
+		FString Name;
+		mutable std::atomic<uint32> EventIds[33] = {};
+	};
+
+	/** Returns the names of the given components, separated by commas */
+	template<typename... Component>
+	const FString& ComponentSetName()
+	{
+		static const FString Name = FString::Join(TArray<FString>{ ECS::TypeName<Component>()... }, TEXT(", "));
+		return Name;
+	}
+
+	template<typename... Exclude, typename... Component>
+	const FScopeName& QueryName(const entt::basic_view<entt::entity, entt::exclude_t<Exclude...>, Component...>&)
+	{
+		static const FScopeName Name(sizeof...(Exclude) > 0
+			? FString::Printf(TEXT("ECS View: %s Exclude: %s"), *ComponentSetName<Component...>(), *ComponentSetName<Exclude...>())
+			: FString::Printf(TEXT("ECS View: %s"), *ComponentSetName<Component...>()));
+		return Name;
+	}
+
+	template<typename... Exclude, typename... Get, typename... Owned>
+	const FScopeName& QueryName(const entt::basic_group<entt::entity, entt::exclude_t<Exclude...>, entt::get_t<Get...>, Owned...>&)
+	{
+		static const FScopeName Name(FString::Printf(TEXT("ECS Group: %s%s%s%s%s"), *ComponentSetName<Owned...>(),
+			sizeof...(Get) > 0 ? TEXT(" Get: ") : TEXT(""), *ComponentSetName<Get...>(),
+			sizeof...(Exclude) > 0 ? TEXT(" Exclude: ") : TEXT(""), *ComponentSetName<Exclude...>()));
+		return Name;
+	}
+
+	template<typename Query, typename = void>
+	struct THasSizeHint : std::false_type {};
+
+	template<typename Query>
+	struct THasSizeHint<Query, std::void_t<decltype(std::declval<const Query&>().size_hint())>> : std::true_type {};
+
+	/** Returns the number of entities of a group or the estimated number of a view */
+	template<typename Query>
+	int32 QuerySize(const Query& InQuery)
+	{
+		if constexpr (THasSizeHint<Query>::value)
+		{
+			return static_cast<int32>(InQuery.size_hint());
+		}
+		else
+		{
+			return static_cast<int32>(InQuery.size());
+		}
+	}
+}
+#endif
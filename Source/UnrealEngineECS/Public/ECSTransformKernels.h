@@ -0,0 +1,46 @@
+// Copyright @Paul Larrass 2020
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UEEnTTComponents.h"
+
+
+/**
+ * Batch operations on the split transform components (FECSPosition, FECSRotation, FECSScale, FECSVelocity).
+ * The array versions work on packed arrays and use the vector intrinsics of the platform, the registry versions run them over the
+ * packed pools of a registry, skipping disabled entities and components (@see IECSRegistryInterface::SetEnabled).
+ */
+namespace ECS::Kernels
+{
+	/** Positions[i] += Velocities[i] * DeltaTime */
+	UNREALENGINEECS_API void IntegrateVelocity(FECSPosition* Positions, const FECSVelocity* Velocities, int32 Count, float DeltaTime);
+
+	/** Normalizes all rotations */
+	UNREALENGINEECS_API void NormalizeRotations(FECSRotation* Rotations, int32 Count);
+
+	/** Rotations[i] = Deltas[i] * Rotations[i], so the delta is applied after the current rotation */
+	UNREALENGINEECS_API void ComposeRotations(FECSRotation* Rotations, const FECSRotation* Deltas, int32 Count);
+
+	//////////////////////////////////////////////////
+	/**
+	 * Integrates the velocity of all entities with a position and a velocity.
+	 * Iterates the core group that owns both pools, so both arrays are packed in the same order.
+	 */
+	UNREALENGINEECS_API void IntegrateVelocity(IECSRegistryInterface& Registry, float DeltaTime);
+
+	/** Normalizes the rotations of all entities */
+	UNREALENGINEECS_API void NormalizeRotations(IECSRegistryInterface& Registry);
+
+	/**
+	 * Copies the split transform components into the FTransform of the same entity. Entities without a FTransform are skipped,
+	 * and each of the split components is optional.
+	 */
+	UNREALENGINEECS_API void PackTransforms(IECSRegistryInterface& Registry);
+
+	/**
+	 * Copies the transform into the split transform components the entity has, the opposite of PackTransforms().
+	 * Used when the FTransform was written from outside, e.g. by the actor, so the next PackTransforms() doesn't undo it.
+	 */
+	UNREALENGINEECS_API void UnpackTransform(entt::registry& Registry, entt::entity Entity, const FTransform& Transform);
+}
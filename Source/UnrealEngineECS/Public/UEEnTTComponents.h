@@ -42,6 +42,9 @@ struct FActorPtrComponent
 };
 
 //////////////////////////////////////////////////
+/**
+ * Links entities into a hierarchy. References are stored as compact FEntityId's, which are resolved in the registry that owns this
+ * component. With 4 bytes per reference, this component is 16 bytes in size */
 struct FRelationship
 {
     FRelationship(){}
@@ -52,10 +55,19 @@ struct FRelationship
      */
     FRelationship(FEntity Parent, FEntity Owner)
     {
-        this->Parent = Parent;
-        
-        Prev = Parent.GetComponent<FRelationship>().LastChild();
-        Prev.GetComponent<FRelationship>().Next = Owner;
+        IECSRegistryInterface& Registry = Parent.GetRegistry();
+        this->Parent = Parent.GetId();
+
+        FRelationship& ParentRelationship = Parent.GetComponent<FRelationship>();
+        Prev = ParentRelationship.LastChild(Registry);
+        if (Prev)
+        {
+            Prev.Resolve(Registry).GetComponent<FRelationship>().Next = Owner.GetId();
+        }
+        else
+        {
+            ParentRelationship.First = Owner.GetId();
+        }
     }
     
     ~FRelationship()
@@ -64,25 +76,30 @@ struct FRelationship
     }
     
     /** Call the given function for all of our children. Assumes that all children have the relationship component! */
-    void ForEachChildren(TFunction<void(FEntity Child)> Function) const
+    void ForEachChildren(IECSRegistryInterface& Registry, TFunction<void(FEntity Child)> Function) const
     {
-        auto& ParentRelationship = Parent.GetComponent<FRelationship>();
-        auto CurrentEntity = ParentRelationship.First;
+        FEntityId CurrentId = First;
         
-        while(CurrentEntity)
+        while(CurrentId)
         {
+            FEntity CurrentEntity = CurrentId.Resolve(Registry);
             Function(CurrentEntity);
-            CurrentEntity = CurrentEntity.GetComponent<FRelationship>().Next;
+            CurrentId = CurrentEntity.GetComponent<FRelationship>().Next;
         }
     }
 
     /** Returns the last child that is directly attached to us */
-    FEntity LastChild() const
+    FEntityId LastChild(IECSRegistryInterface& Registry) const
     {
-        FEntity Current = First;
+        FEntityId Current = First;
         while (Current)
         {
-            Current = Current.GetComponent<FRelationship>().Next;
+            const FEntityId Next = Current.Resolve(Registry).GetComponent<FRelationship>().Next;
+            if (!Next)
+            {
+                break;
+            }
+            Current = Next;
         }
         return Current;
     }
@@ -91,16 +108,43 @@ struct FRelationship
     //---------- Variables ----------//
 public:
     /* The first entity which is attached to us */
-    FEntity First = FEntity::NullEntity;
+    FEntityId First = FEntityId::NullId;
 
     /* When we are attached to an entity, this is our previous sibling in our parent's list of children */
-    FEntity Prev = FEntity::NullEntity;
+    FEntityId Prev = FEntityId::NullId;
 
     /* When we are attached to an entity, this is our next sibling in our parent's list of children */
-    FEntity Next = FEntity::NullEntity;
+    FEntityId Next = FEntityId::NullId;
 
     /* The entity that we are attached, too */
-    FEntity Parent = FEntity::NullEntity;
+    FEntityId Parent = FEntityId::NullId;
+};
+
+
+//////////////////////////////////////////////////
+/*
+ * Split transform components. Each of them lives in its own pool, so a system that only moves entities only touches the positions
+ * and velocities. @see ECSTransformKernels.h for batch operations on them.
+ * When an entity also has a FTransform, it is rebuilt from these components before it's copied to the actor.
+ */
+struct FECSPosition
+{
+    FVector Value = FVector::ZeroVector;
+};
+
+struct FECSRotation
+{
+    FQuat Value = FQuat::Identity;
+};
+
+struct FECSScale
+{
+    FVector Value = FVector::OneVector;
+};
+
+struct FECSVelocity
+{
+    FVector Value = FVector::ZeroVector;
 };
 
 
@@ -118,14 +162,22 @@ enum class ESyncType : uint8
     BothWays
 };
 
+/* Marks entities whose actor transform is copied to the ECS. Disabled (@see FEntity::SetComponentEnabled) while the sync is off */
 struct FSyncTransformToECS
 {
-    /* Flag set by the actor component to indicate that the actor's transform changed and should be synced to ECS.
-     * This is done because the ECS can run multi-threaded and we want to ensure that the transform is only synced to the ECS before
-     * any system has updated */
-    bool bSyncTransform = false;
 };
 
+/* Tag added by the actor component when the actor's transform changed and should be synced to ECS.
+ * This is done because the ECS can run multi-threaded and we want to ensure that the transform is only synced to the ECS before
+ * any system has updated. Entities without the tag are not touched by the sync at all */
+struct FActorTransformChanged
+{
+};
+
+/**
+ * Settings of entities whose transform is copied to the actor. Usually equal for many entities, so it's a shared value
+ * (@see FEntity::SetShared). The entities have a TECSShared<FSyncTransformToActor>, which is disabled while the sync is off.
+ */
 USTRUCT(BlueprintType)
 struct FSyncTransformToActor
 {
@@ -138,8 +190,15 @@ struct FSyncTransformToActor
     UPROPERTY(EditDefaultsOnly)
     ETeleportType TeleportType = ETeleportType::None;
 
-    /* Flag which indicates if the transform should be synced from ECS to the actor */
-    bool bSyncTransform = true;
+    bool operator==(const FSyncTransformToActor& Other) const
+    {
+        return bSweep == Other.bSweep && TeleportType == Other.TeleportType;
+    }
+
+    friend uint32 GetTypeHash(const FSyncTransformToActor& Settings)
+    {
+        return HashCombine(GetTypeHash(Settings.bSweep), GetTypeHash(static_cast<uint8>(Settings.TeleportType)));
+    }
 };
 
 
@@ -155,6 +214,10 @@ class UNREALENGINEECS_API UECS_BridgeComponent : public UECSComponentWrapper
 
 public:
     virtual void RegisterComponentWithECS() override;
+    virtual void ReserveECSComponents(IECSRegistryInterface& Registry, TArrayView<UECSComponentWrapper* const> Instances) const override;
+
+    /** Registered before all other wrappers, which rely on the FActorPtrComponent */
+    virtual int32 GetRegistrationPriority() const override { return -1; }
 };
 
 
@@ -168,6 +231,7 @@ class UNREALENGINEECS_API UECS_SyncTransformComponent : public UECSComponentWrap
 
 public:
     virtual void RegisterComponentWithECS() override;
+    virtual void ReserveECSComponents(IECSRegistryInterface& Registry, TArrayView<UECSComponentWrapper* const> Instances) const override;
 
 private:
     void OnRootComponentTransformChanged(USceneComponent* UpdatedComponent, EUpdateTransformFlags UpdateTransformFlags,
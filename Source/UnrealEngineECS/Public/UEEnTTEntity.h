@@ -9,6 +9,76 @@
 #include "UEEnTTEntity.generated.h"
 
 
+/**
+ * Compile-time policy for the component accessors of FEntity.
+ * When 1, AddComponent(), RemoveComponent(), GetComponent() and GetComponents() assert when used wrongly. When 0, these checks are
+ * compiled out. Either way each accessor does only one lookup in the component pool.
+ * Defaults to DO_GUARD_SLOW, so only Debug builds pay for the checks. Add "ECS_CHECKED_ACCESS=1" to your PublicDefinitions to
+ * force them on.
+ */
+#ifndef ECS_CHECKED_ACCESS
+	#define ECS_CHECKED_ACCESS DO_GUARD_SLOW
+#endif
+
+
+/**
+ * Compact entity reference for use inside components. Holds only the entity identifier (4 bytes), the registry is implied by the
+ * context in which the reference is used (usually the registry that owns the component holding it).
+ * Use Resolve() to turn it into a full FEntity handle when you need to access components.
+ */
+struct UNREALENGINEECS_API FEntityId
+{
+    FEntityId(){}
+    FEntityId(entt::entity Handle) : EntityHandle(Handle) {}
+    FEntityId(const struct FEntity& Entity);
+
+    /** Returns a full entity handle for this id in the given registry */
+    struct FEntity Resolve(IECSRegistryInterface& Registry) const;
+
+    /** Returns the underlying EnTT identifier */
+    entt::entity GetHandle() const
+    {
+        return EntityHandle;
+    }
+
+    /**
+     * Does the entity still exist in the given registry?
+     * The identifier contains the version of the entity, so this is false for destroyed entities, even when their index was
+     * recycled. Only compares the version, no component pool is probed.
+     */
+    bool IsValid(const IECSRegistryInterface& Registry) const;
+
+    /** Is this not the null id? Doesn't check whether the entity still exists, @see IsValid */
+    explicit operator bool() const
+    {
+        return EntityHandle != entt::null;
+    }
+
+    bool operator==(const FEntityId& Other) const
+    {
+        return Other.EntityHandle == EntityHandle;
+    }
+
+    bool operator!=(const FEntityId& Other) const
+    {
+        return Other.EntityHandle != EntityHandle;
+    }
+
+    friend uint32 GetTypeHash(const FEntityId& Id)
+    {
+        return static_cast<uint32>(Id.EntityHandle);
+    }
+
+    static const FEntityId NullId;
+
+private:
+    entt::entity EntityHandle = entt::null;
+};
+
+static_assert(sizeof(FEntityId) == sizeof(entt::entity), "FEntityId must stay as small as the raw EnTT identifier");
+
+
+//////////////////////////////////////////////////
 /** Entity struct. Because of it's small size, you don't need to pass it around by reference, instead just copy it */
 USTRUCT(BlueprintType)
 struct UNREALENGINEECS_API FEntity
@@ -16,19 +86,24 @@ struct UNREALENGINEECS_API FEntity
     GENERATED_BODY()
     
     friend class IECSRegistryInterface;
+    friend struct FEntityId;
     
 public:
     FEntity(){}
     FEntity(entt::entity Handle, IECSRegistryInterface& Registry);
+    FEntity(FEntityId Id, IECSRegistryInterface& Registry);
 
 
     //---------- Functions ----------//
 public:
-    /** Add a component and pass through it's constructor arguments */
+    /** Add a component and pass through it's constructor arguments. Asserts when we already have the component */
     template<typename Component, typename... Args>
 	Component& AddComponent(Args&&... args)
     {
+        ECS_RECORD_ACCESS(Component);
+#if ECS_CHECKED_ACCESS
     	checkf(!HasComponent<Component>(), TEXT("We already have a component with that class"));
+#endif
     	return OwningRegistry->Registry.emplace<Component>(EntityHandle, std::forward<Args>(args)...);
     }
 
@@ -43,15 +118,32 @@ public:
     template<typename Component, typename... Args>
     decltype(auto) AddOrReplaceComponent(Args&&... args)
     {
+        ECS_RECORD_ACCESS(Component);
         return OwningRegistry->Registry.emplace_or_replace<Component, Args...>(EntityHandle, std::forward<Args>(args)...);
     }
 
+    /**
+     * Updates the given component in place and notifies the update listeners (OnUpdate, batched events, replay recording).
+     * Changes made through the reference returned by GetComponent() are not signaled.
+     * @param Functions Called as void(Component&)
+     */
+    template<typename Component, typename... Func>
+    decltype(auto) PatchComponent(Func&&... Functions)
+    {
+        ECS_RECORD_ACCESS(Component);
+        return OwningRegistry->Registry.patch<Component>(EntityHandle, std::forward<Func>(Functions)...);
+    }
+
     /** Removes the given component from this entity. Asserts when we don't have the component */
     template<typename Component>
 	void RemoveComponent()
     {
-    	checkf(HasComponent<Component>(), TEXT("We don't have a component with that class"));
+        ECS_RECORD_ACCESS(Component);
+#if ECS_CHECKED_ACCESS
+    	verifyf(RemoveComponentChecked<Component>(), TEXT("We don't have a component with that class"));
+#else
     	OwningRegistry->Registry.remove<Component>(EntityHandle);
+#endif
     }
     
     /**
@@ -61,6 +153,7 @@ public:
     template<typename Component>
 	bool RemoveComponentChecked()
     {
+        ECS_RECORD_ACCESS(Component);
     	return OwningRegistry->Registry.remove_if_exists<Component>(EntityHandle) > 0;
     }
 
@@ -68,30 +161,59 @@ public:
     template<typename Component>
 	Component& GetComponent()
     {
-    	checkf(HasComponent<Component>(), TEXT("We don't have a component with that class"));
-    	return OwningRegistry->Registry.get<Component>(EntityHandle);
+    	return GetComponentInternal<Component>();
     }
 
     /** Returns the given component from this entity. Asserts when we don't have the component */
     template<typename Component>
 	Component& GetComponent() const
     {
-    	checkf(HasComponent<Component>(), TEXT("We don't have a component with that class"));
-    	return OwningRegistry->Registry.get<Component>(EntityHandle);
+    	return GetComponentInternal<Component>();
     }
 
-    /** Returns the given component from this entity. Asserts when we don't have the component */
+    /** Returns the given components from this entity. Asserts when we don't have all of them */
     template<typename... Component>
     decltype(auto) GetComponents()
     {
-        checkf(HasAllComponent<Component...>(), TEXT("We don't have all components with these classes"));
-        return OwningRegistry->Registry.get<Component...>(EntityHandle);
+        if constexpr (sizeof...(Component) == 1)
+        {
+            return GetComponentInternal<Component...>();
+        }
+        else
+        {
+#if ECS_CHECKED_ACCESS
+            const auto Found = TryGetComponents<Component...>();
+            checkf((std::get<Component*>(Found) && ...), TEXT("We don't have all components with these classes"));
+            return std::forward_as_tuple(*std::get<Component*>(Found)...);
+#else
+            ECS_RECORD_ACCESS(Component...);
+            return OwningRegistry->Registry.get<Component...>(EntityHandle);
+#endif
+        }
+    }
+
+    /** Returns a pointer to the given component, or nullptr if we don't have it */
+    template<typename Component>
+    Component* TryGetComponent() const
+    {
+        ECS_RECORD_ACCESS(Component);
+        return OwningRegistry->Registry.try_get<Component>(EntityHandle);
+    }
+
+    /** Returns a tuple with pointers to the given components. Components that we don't have are nullptr */
+    template<typename... Component>
+    auto TryGetComponents() const
+    {
+        static_assert(sizeof...(Component) > 1, "Use TryGetComponent() for a single component");
+        ECS_RECORD_ACCESS(Component...);
+        return OwningRegistry->Registry.try_get<Component...>(EntityHandle);
     }
 
     /** Do we have any of the given components? */
     template<typename... Component>
 	bool HasComponent() const
     {
+        ECS_RECORD_ACCESS(const Component...);
     	return OwningRegistry->Registry.any<Component...>(EntityHandle);
     }
 
@@ -99,18 +221,127 @@ public:
     template<typename... Component>
 	bool HasAllComponent() const
     {
+        ECS_RECORD_ACCESS(const Component...);
     	return OwningRegistry->Registry.has<Component...>(EntityHandle);
     }
 
 
+    /** Adds the given tag, an empty component, and sets its bit in our tag signature. Does nothing if we already have the tag */
+    template<typename Tag>
+    void AddTag()
+    {
+        FECSTagSignature& Signature = OwningRegistry->Registry.get_or_emplace<FECSTagSignature>(EntityHandle);
+        const uint64 Bit = ECS::TagBit<Tag>();
+        if ((Signature.Mask & Bit) == 0)
+        {
+            Signature.Mask |= Bit;
+            OwningRegistry->Registry.emplace<Tag>(EntityHandle);
+        }
+    }
+
+    /** Removes the given tag. Does nothing if we don't have the tag */
+    template<typename Tag>
+    void RemoveTag()
+    {
+        FECSTagSignature* Signature = TryGetComponent<FECSTagSignature>();
+        const uint64 Bit = ECS::TagBit<Tag>();
+        if (Signature && (Signature->Mask & Bit) != 0)
+        {
+            Signature->Mask &= ~Bit;
+            OwningRegistry->Registry.remove<Tag>(EntityHandle);
+        }
+    }
+
+    /** Do we have all of the given tags? Only tests our tag signature */
+    template<typename... Tag>
+    bool HasTag() const
+    {
+        const FECSTagSignature* Signature = TryGetComponent<FECSTagSignature>();
+        return Signature && Signature->Matches(ECS::TagMask<Tag...>());
+    }
+
+    /** Enables or disables this entity without touching its components. @see IECSRegistryInterface::SetEnabled */
+    void SetEnabled(bool bEnabled);
+    bool IsEnabled() const;
+
+    /** Enables or disables one of our components without removing it. @see IECSRegistryInterface::SetComponentEnabled */
+    template<typename Component>
+    void SetComponentEnabled(bool bEnabled)
+    {
+        OwningRegistry->SetComponentEnabled<Component>(EntityHandle, bEnabled);
+    }
+
+    template<typename Component>
+    bool IsComponentEnabled() const
+    {
+        return OwningRegistry->IsComponentEnabled<Component>(EntityHandle);
+    }
+
+    /** Sets our shared value of type T, deduplicated with all equal values. @see TECSSharedStore */
+    template<typename T>
+    void SetShared(const T& Value)
+    {
+        ECS_RECORD_ACCESS(TECSShared<T>);
+        OwningRegistry->Shared<T>().Set(EntityHandle, Value);
+    }
+
+    /** Returns our shared value of type T. Asserts when we don't have one */
+    template<typename T>
+    const T& GetShared() const
+    {
+        ECS_RECORD_ACCESS(const TECSShared<T>);
+        return OwningRegistry->Shared<T>().GetForEntity(EntityHandle);
+    }
+
+    /** Returns the compact identifier of this entity, e.g. for storing it inside a component */
+    FEntityId GetId() const
+    {
+        return FEntityId(EntityHandle);
+    }
+
+    /** Returns the registry this entity belongs to. Asserts when this is a null entity */
+    IECSRegistryInterface& GetRegistry() const
+    {
+        checkf(OwningRegistry, TEXT("The entity doesn't belong to a registry"));
+        return *OwningRegistry;
+    }
+
+
+    /**
+     * Does the entity still exist in its registry?
+     * Compares the version of our handle with the current version of the entity, so handles to destroyed entities are invalid even
+     * when the entity's index was recycled. Much cheaper than probing a component pool.
+     */
+    bool IsValid() const;
+
+
     //---------- Operators ----------//
 public:
+    /** Same as IsValid() */
     explicit operator bool() const;
+
+    /** Entities are equal when they have the same handle (including the version) and belong to the same registry */
     bool operator==(const FEntity& Other) const;
     bool operator!=(const FEntity& Other) const;
     FEntity& operator=(const entt::entity& OtherHandle);
 
 
+private:
+    /** Single lookup accessor. With ECS_CHECKED_ACCESS, the lookup result is checked instead of probing the pool twice */
+    template<typename Component>
+    Component& GetComponentInternal() const
+    {
+        ECS_RECORD_ACCESS(Component);
+#if ECS_CHECKED_ACCESS
+        Component* Found = TryGetComponent<Component>();
+        checkf(Found, TEXT("We don't have a component with that class"));
+        return *Found;
+#else
+        return OwningRegistry->Registry.get<Component>(EntityHandle);
+#endif
+    }
+
+
     //---------- Variables ----------//    
 public:
     static const FEntity NullEntity;
@@ -4,6 +4,7 @@
 
 #include "CoreMinimal.h"
 #include "Engine/EngineBaseTypes.h"
+#include "Async/TaskGraphInterfaces.h"
 #include "Subsystems/GameInstanceSubsystem.h"
 
 #include "UEEnTTSystem.generated.h"
@@ -59,13 +60,57 @@ public:
 
 	/** Main function for systems. This is called each tick (or how long the tick function is set to) */
 	virtual void RunSystem(float DeltaTime, ENamedThreads::Type CurrentThread) const {};	
+
+	/**
+	 * Makes this system's tick wait for the given system to complete, including any async work the other system launched.
+	 * Both systems have to be registered with the same world.
+	 */
+	void AddSystemPrerequisite(UECSSystem& Other);
+
+	/** Returns the tasks launched by the last RunSystem() call that may still be running */
+	const FGraphEventArray& GetPendingTasks() const { return PendingTasks; }
+
+	/** Call from RunSystem() with the number of entities that were processed, for the entity throughput in the registry's stats */
+	void ReportProcessedEntities(int32 Num) const { NumProcessedEntities += Num; }
 	
 protected:
 	void RegisterTickFunction(UWorld* World);
+
+	/**
+	 * Lets the tick function of this system complete as late as the end of the given tick group, so the work of LaunchTask() can
+	 * overlap with later tick groups (e.g. physics). Call from the constructor, after the tick group was set.
+	 * Without it, the system's own tick group can't end before the work is done.
+	 */
+	void SetAsyncEndTickGroup(ETickingGroup EndTickGroup)
+	{
+		TickFunction.EndTickGroup = EndTickGroup;
+	}
+
+	/**
+	 * Launches work on the task graph from within RunSystem().
+	 * The tick function of this system will not complete until the task is done, so systems that have this system as a prerequisite
+	 * still see the finished results. The work only overlaps with the tick groups up to the end tick group of this system
+	 * (@see SetAsyncEndTickGroup), by default the system's tick group waits for it.
+	 * @param Work			The work to do. Must not access the registry through pools that other systems write to concurrently
+	 * @param Prerequisites	Optional tasks that have to finish before the work starts, e.g. the result of an earlier LaunchTask() call
+	 * @param Thread		The thread to run the work on
+	 * @return The completion event of the task, can be passed as a prerequisite to further tasks
+	 */
+	FGraphEventRef LaunchTask(TUniqueFunction<void()>&& Work, const FGraphEventArray* Prerequisites = nullptr,
+							  ENamedThreads::Type Thread = ENamedThreads::AnyBackgroundThreadNormalTask) const;
 	
 	
 	//---------- Variables ----------//
 public:
 	FECSSystemTickFunction TickFunction;
 	class IECSRegistryInterface* Registry = nullptr;
+
+private:
+	friend struct FECSSystemTickFunction;
+
+	/* Tasks launched during the current RunSystem() call. Handed to the tick function's completion event after RunSystem() returns */
+	mutable FGraphEventArray PendingTasks;
+
+	/* Entities reported by the current RunSystem() call */
+	mutable int32 NumProcessedEntities = 0;
 };